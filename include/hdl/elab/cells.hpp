@@ -0,0 +1,110 @@
+#pragma once
+// Primitive (leaf) cell library and the packed per-module table of
+// primitive instances. A gate-level netlist is almost all standard cells;
+// binding them as CellType ids plus one local BitId per pin skips the
+// ModuleDecl -> ModuleSpec -> BitMap path and the per-instance
+// ConnSpec/BitVector allocations entirely.
+//
+// Library text format, one statement per line, '#' to end of line is a
+// comment:
+//
+//   cell NAND2
+//     pin A in
+//     pin B in
+//     pin Y out
+//     arc A Y        # optional combinational pin-to-pin arcs
+//     arc B Y
+//   end
+//
+// Pins are scalar. A cell without arcs is opaque: tracing treats it as
+// all-inputs -> all-outputs, like a leaf module with no body.
+//
+// Primitives have no scope. Net-level passes (fanout, cones, lint, port
+// models, loops, constants, rollups, flat graph) see them, and
+// dump-hierarchy lists them. Scope-based paths do not: walkInstances
+// never yields them, and PathResolver cannot name a cell pin such as
+// "u_core/U12.A", so cell pins cannot be selected.
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/common.hpp"
+#include "hdl/net/connectivity.hpp"
+#include "hdl/util/id_string.hpp"
+
+namespace hdl::elab {
+
+struct CellPin {
+    IdString mName;
+    PortDirection mDir = PortDirection::In;
+};
+
+struct CellArc {
+    uint32_t mFrom = 0; // pin indices
+    uint32_t mTo = 0;
+};
+
+struct CellType {
+    IdString mName;
+    std::vector<CellPin> mPins;
+    std::vector<CellArc> mArcs;
+
+    int findPin(IdString n) const;
+    bool opaque() const { return mArcs.empty(); }
+};
+
+class CellLibrary {
+  public:
+    // Parses the text format above. Cells defined again replace the
+    // earlier definition in place, so type ids already handed out stay
+    // valid. Returns false (after reporting) on the first malformed
+    // statement; cells completed before it are kept.
+    bool load(std::istream& in, std::ostream* diag);
+    bool loadFile(const std::string& path, std::ostream* diag);
+
+    // Type id, or -1.
+    int findIndex(IdString name) const;
+    const CellType& type(uint32_t id) const { return mTypes[id]; }
+    uint32_t size() const { return static_cast<uint32_t>(mTypes.size()); }
+    bool empty() const { return mTypes.empty(); }
+
+  private:
+    std::vector<CellType> mTypes;
+    std::unordered_map<IdString, uint32_t, IdString::Hash> mIndex;
+};
+
+// Primitive instances of one module as parallel arrays. Pin bits are local
+// BitIds in the owning spec (nets via its BitMap), kOpenPin if unbound.
+struct PrimTable {
+    static constexpr net::BitId kOpenPin = UINT32_MAX;
+
+    const CellLibrary* mLib = nullptr;
+    std::vector<IdString> mNames;
+    std::vector<uint32_t> mTypes;      // CellLibrary type ids
+    std::vector<uint32_t> mPinOffsets; // CSR instance -> mPinBits
+    std::vector<net::BitId> mPinBits;
+
+    uint32_t size() const { return static_cast<uint32_t>(mTypes.size()); }
+    bool empty() const { return mTypes.empty(); }
+    const CellType& type(uint32_t i) const { return mLib->type(mTypes[i]); }
+    std::span<const net::BitId> pins(uint32_t i) const {
+        return {mPinBits.data() + mPinOffsets[i],
+                mPinBits.data() + mPinOffsets[i + 1]};
+    }
+    std::span<net::BitId> pins(uint32_t i) {
+        return {mPinBits.data() + mPinOffsets[i],
+                mPinBits.data() + mPinOffsets[i + 1]};
+    }
+
+    // Appends an instance with every pin open; returns its index.
+    uint32_t add(IdString name, uint32_t typeId);
+    void clear();
+    size_t memoryBytes() const;
+};
+
+} // namespace hdl::elab
@@ -8,6 +8,7 @@
 
 #include "hdl/elab/flatten.hpp"
 #include "hdl/elab/spec.hpp"
+#include "hdl/hier/scope.hpp"
 
 namespace hdl::elab {
 
@@ -34,35 +35,38 @@ ModuleSpec& getOrCreateSpec(const ast::ModuleDecl& decl,
 
 using ModuleDeclLib =
   std::unordered_map<IdString, const ast::ModuleDecl, IdString::Hash>;
+// Targets found in `cells` become primitive instances (spec.mPrims) and
+// take precedence over modules of the same name.
 void linkInstances(ModuleSpec& spec, const ModuleDeclLib& declLib,
-                   ModuleSpecLib& specLib, std::ostream* diag);
+                   ModuleSpecLib& specLib, std::ostream* diag,
+                   const CellLibrary* cells = nullptr);
+// Link spec and every spec reachable from it, each exactly once.
+void linkHierarchy(ModuleSpec& top, const ModuleDeclLib& declLib,
+                   ModuleSpecLib& specLib, std::ostream* diag,
+                   const CellLibrary* cells = nullptr);
 
 // Hierarchy dump using ModuleSpec -> InstanceSpec -> ModuleSpec pattern.
 namespace hier {
 
-struct ScopeId {
-    std::vector<uint32_t> mPath; // child instance indices along hierarchy
-    std::string toString() const {
-        if (mPath.empty()) return "<root>";
-        std::string s;
-        for (size_t i = 0; i < mPath.size(); ++i) {
-            if (i) s.push_back('/');
-            s += std::to_string(mPath[i]);
-        }
-        return s;
-    }
+struct PinKey {
+    ScopeHandle mScope = kRootScope;
+    uint32_t mPortIndex = 0; // port index in the scope's spec
 };
+static_assert(sizeof(PinKey) == 8);
 
-struct PinKey {
-    ScopeId mScope;
-    uint32_t mPortIndex = 0; // child-side port index at end of scope path
+struct DumpOptions {
+    uint32_t mMaxDepth = UINT32_MAX; // instances below this depth are elided
+    // Expand each specialization once; later occurrences print a
+    // back-reference to the scope where it was expanded.
+    bool mDedup = false;
 };
 
-// Dump instance hierarchy recursively.
-void dumpInstanceTree(const ModuleSpec& top, std::ostream& os);
+// Dump instance hierarchy recursively, writing to os as it goes.
+void dumpInstanceTree(const ModuleSpec& top, std::ostream& os,
+                      const DumpOptions& opts = {});
 
-// Optional: derive a PinKey to a named port at a scope path.
-bool makePinKey(const ModuleSpec& top, const ScopeId& scope, IdString portName,
+// Optional: derive a PinKey to a named port at an interned scope.
+bool makePinKey(const ScopeTable& scopes, ScopeHandle scope, IdString portName,
                 PinKey& out, std::ostream* diag = nullptr);
 
 } // namespace hier
@@ -0,0 +1,61 @@
+#pragma once
+// Per-module driver/load index. Connectivity only groups equal bits; this
+// records, per local net, which endpoints write it and which read it, in
+// two CSR arrays so queries never rescan instances.
+//
+// Endpoints are the module's own port bits (an input drives the net from
+// outside, an output is read from outside), child instance pins (by the
+// callee port direction; inout counts as both), primitive cell pins (by the
+// cell pin direction), the tie-0/tie-1 bits that constant bindings use and
+// constant assigns (one Const driver per assigned bit). Other assigns alias
+// their bits into one net, so they never separate a driver from a load and
+// are not recorded.
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "hdl/net/connectivity.hpp"
+#include "hdl/util/spill.hpp"
+
+namespace hdl::elab {
+
+struct ModuleSpec;
+
+enum class EndpointKind : uint8_t { Port, ChildPin, Const, Cell };
+
+struct NetEndpoint {
+    EndpointKind mKind = EndpointKind::Port;
+    // port (Port), instance (ChildPin), 0/1 (Const), primitive (Cell)
+    uint32_t mIndex = 0;
+    uint32_t mPort = 0; // callee port index (ChildPin), cell pin (Cell)
+    uint32_t mBit = 0;   // LSB-first offset within the port
+};
+
+struct FanoutIndex {
+    FrozenArray<uint32_t> mDriverOffsets; // CSR net -> drivers
+    FrozenArray<NetEndpoint> mDrivers;
+    FrozenArray<uint32_t> mLoadOffsets; // CSR net -> loads
+    FrozenArray<NetEndpoint> mLoads;
+
+    // Needs a frozen BitMap and linked instances (built InstanceTable).
+    void build(const ModuleSpec& spec);
+    void clear() { *this = FanoutIndex{}; }
+
+    bool built() const { return !mDriverOffsets.empty(); }
+    net::NetId netCount() const {
+        return built() ? static_cast<net::NetId>(mDriverOffsets.size() - 1)
+                       : 0;
+    }
+    std::span<const NetEndpoint> drivers(net::NetId n) const {
+        const NetEndpoint* eps = mDrivers.data();
+        return {eps + mDriverOffsets[n], eps + mDriverOffsets[n + 1]};
+    }
+    std::span<const NetEndpoint> loads(net::NetId n) const {
+        const NetEndpoint* eps = mLoads.data();
+        return {eps + mLoadOffsets[n], eps + mLoadOffsets[n + 1]};
+    }
+    size_t memoryBytes() const;
+};
+
+} // namespace hdl::elab
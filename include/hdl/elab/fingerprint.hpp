@@ -0,0 +1,41 @@
+#pragma once
+// Structural fingerprints and merging of equivalent specializations.
+// Parameter sets that do not change a module's elaborated structure yield
+// identical specs; merging keeps one canonical entry and turns the others
+// into alias stubs (ModuleSpec::mAliasOf) that getOrCreateSpec forwards.
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab {
+
+using SpecFingerprints = std::unordered_map<const ModuleSpec*, uint64_t>;
+
+// Hash over module name, port/wire shapes, the frozen connectivity
+// partition and instances (name, callee fingerprint, bindings). Callees
+// must already be in `fps`; params are deliberately not hashed.
+uint64_t structuralFingerprint(const ModuleSpec& spec,
+                               const SpecFingerprints& fps);
+
+// Exact comparison backing a fingerprint match. Callees compare by
+// identity, so merge children first.
+bool structurallyEqual(const ModuleSpec& a, const ModuleSpec& b);
+
+struct SpecMergeStats {
+    size_t mSpecs = 0;  // live specs before merging
+    size_t mMerged = 0; // turned into alias stubs
+    size_t mBytesBefore = 0;
+    size_t mBytesAfter = 0;
+    size_t reclaimed() const { return mBytesBefore - mBytesAfter; }
+};
+
+// Merges bottom-up so parents that differ only by which duplicate child
+// they instantiate merge too. Rewrites callees and where-used edges;
+// external caches keyed by spec pointer must be dropped by the caller.
+SpecMergeStats mergeEquivalentSpecs(ModuleSpecLib& lib,
+                                    std::ostream* diag = nullptr);
+
+} // namespace hdl::elab
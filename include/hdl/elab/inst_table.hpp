@@ -0,0 +1,96 @@
+#pragma once
+// Frozen struct-of-arrays view of a module's instances. mInstances (one
+// InstanceSpec per instance, one ConnSpec and BitVector per bound port)
+// stays the builder view used by linking, editing and dumps; traversals
+// read this table instead: a handful of flat arrays per module, with every
+// instance's pin bits in one shared array.
+//
+// An instance's slice of mBits is indexed by the callee's port BitId
+// (ports are allocated first, so that is [0, calleePortBits)) and holds
+// the bound local bit in the parent, kOpenPin if unbound. Constant
+// actuals hold the parent's tie bits. Large modules (flat netlists) keep
+// the pin bits run/delta packed and decode them on access.
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "hdl/net/connectivity.hpp"
+#include "hdl/net/packed_bits.hpp"
+#include "hdl/util/id_string.hpp"
+#include "hdl/util/spill.hpp"
+
+namespace hdl::elab {
+
+struct ModuleSpec;
+
+// One instance's pins, indexed by callee port bit; reads either storage.
+// operator[] decodes a packed block per call, so loops over a whole slice
+// use decode() instead.
+class PinSlice {
+  public:
+    PinSlice(const net::BitId* raw, const net::PackedBitArray* packed,
+             uint32_t lo, uint32_t size)
+        : mRaw(raw)
+        , mPacked(packed)
+        , mLo(lo)
+        , mSize(size) {}
+    uint32_t size() const { return mSize; }
+    net::BitId operator[](uint32_t k) const {
+        return mRaw ? mRaw[k] : (*mPacked)[mLo + k];
+    }
+    // All pins at once: the raw storage itself, or the packed blocks
+    // decoded once into scratch.
+    std::span<const net::BitId> decode(std::vector<net::BitId>& scratch) const {
+        if (mRaw) return {mRaw, mSize};
+        scratch.resize(mSize);
+        mPacked->decode(mLo, mSize, scratch.data());
+        return scratch;
+    }
+
+  private:
+    const net::BitId* mRaw; // nullptr when packed
+    const net::PackedBitArray* mPacked;
+    uint32_t mLo;
+    uint32_t mSize;
+};
+
+struct InstanceTable {
+    static constexpr net::BitId kOpenPin = UINT32_MAX;
+    // Pin arrays at least this long are packed when that is smaller.
+    static constexpr size_t kPackMin = size_t(1) << 16;
+
+    std::vector<IdString> mNames;
+    std::vector<uint32_t> mCallees; // index into mCalleeSpecs
+    std::vector<const ModuleSpec*> mCalleeSpecs; // distinct callees
+    std::vector<uint32_t> mConnOffsets; // CSR instance -> pin bits
+    FrozenArray<net::BitId> mBits;      // empty once packed; spillable
+    net::PackedBitArray mPacked;
+
+    // Needs linked instances; rebuilt by linkInstances.
+    void build(const ModuleSpec& spec, size_t packMin = kPackMin);
+    void clear() { *this = InstanceTable{}; }
+
+    bool built() const { return !mConnOffsets.empty(); }
+    bool packed() const { return !mPacked.empty(); }
+    uint32_t size() const { return static_cast<uint32_t>(mCallees.size()); }
+    uint32_t pinCount() const { return mConnOffsets.back(); }
+    const ModuleSpec* callee(uint32_t i) const {
+        return mCalleeSpecs[mCallees[i]];
+    }
+    PinSlice bits(uint32_t i) const {
+        uint32_t lo = mConnOffsets[i];
+        return {packed() ? nullptr : mBits.data() + lo,
+                &mPacked,
+                lo,
+                mConnOffsets[i + 1] - lo};
+    }
+    // Parent bit bound to callee port bit calleeBit, or kOpenPin.
+    net::BitId bit(uint32_t i, net::BitId calleeBit) const {
+        PinSlice s = bits(i);
+        return calleeBit < s.size() ? s[calleeBit] : kOpenPin;
+    }
+    size_t memoryBytes() const;
+};
+
+} // namespace hdl::elab
@@ -0,0 +1,63 @@
+#pragma once
+// Structural lint over linked specs. Per-net driver/load counts come from
+// the FanoutIndex offsets (adjacent differences over dense arrays), are
+// folded into per-net bitsets, and each check is a word-wise mask over
+// those bitsets. Specs are checked in parallel; the result is a table of
+// rows that can be counted and filtered rather than printed text.
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab {
+
+enum class LintKind : uint8_t {
+    Undriven,       // net with loads and no driver
+    MultiDriven,    // net with more than one non-inout driver
+    FloatingOutput, // own output port net with no driver (not black boxes)
+    UnusedWire,     // wire whose bits have no driver or load at all
+    WidthMismatch,  // recorded on the spec during elaboration
+};
+inline constexpr size_t kLintKinds = 5;
+
+const char* to_string(LintKind k);
+bool parseLintKind(std::string_view s, LintKind& out);
+
+struct LintRow {
+    const ModuleSpec* mSpec = nullptr;
+    LintKind mKind = LintKind::Undriven;
+    // Representative bit for net checks; wire index for UnusedWire; index
+    // into mSpec->mWidthMismatches for WidthMismatch.
+    uint32_t mItem = 0;
+    uint32_t mCount = 0; // drivers (MultiDriven), unused bits (UnusedWire)
+};
+
+class LintTable {
+  public:
+    const std::vector<LintRow>& rows() const { return mRows; }
+    size_t count(LintKind k) const { return mCounts[size_t(k)]; }
+    size_t size() const { return mRows.size(); }
+    // Rows of one kind, in spec then item order.
+    std::vector<const LintRow*> select(LintKind k) const;
+
+    // Renders a row as "<message>" using the spec's bit/port names.
+    static std::string describe(const LintRow& r);
+
+  private:
+    friend LintTable runLint(std::span<const ModuleSpec* const>,
+                             unsigned);
+    std::vector<LintRow> mRows;
+    std::array<size_t, kLintKinds> mCounts{};
+};
+
+// Specs without a FanoutIndex (never linked) only get width rows.
+// threads == 0 uses hardware concurrency.
+LintTable runLint(std::span<const ModuleSpec* const> specs,
+                  unsigned threads = 0);
+
+} // namespace hdl::elab
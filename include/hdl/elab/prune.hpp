@@ -0,0 +1,31 @@
+#pragma once
+// Optional dead-wire pruning, run after linkInstances. A wire is dead when
+// none of its bits is referenced by an assign, an instance binding or a
+// primitive cell pin; dead wires are dropped from mWires and the BitMap is
+// rebuilt without them, replaying the old partition onto the surviving
+// bits.
+//
+// Ports are never pruned: they are the interface, and their BitIds (the
+// first ones) stay stable, so parents and caches keyed by port bits remain
+// valid. Net ids do change; the FanoutIndex is rebuilt here, and anything
+// else holding net ids of the spec must be dropped by the caller.
+
+#include <cstddef>
+#include <ostream>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab {
+
+struct PruneStats {
+    size_t mWires = 0; // removed
+    size_t mBits = 0;
+    size_t mBytesBefore = 0;
+    size_t mBytesAfter = 0;
+    size_t saved() const { return mBytesBefore - mBytesAfter; }
+};
+
+// Updates mWireRemap / mPrunedWires. Needs a frozen BitMap.
+PruneStats pruneDeadWires(ModuleSpec& spec);
+
+} // namespace hdl::elab
@@ -8,6 +8,9 @@
 #include "hdl/ast/decl.hpp"
 #include "hdl/common.hpp"
 #include "hdl/elab/bits.hpp"
+#include "hdl/elab/cells.hpp"
+#include "hdl/elab/fanout.hpp"
+#include "hdl/elab/inst_table.hpp"
 #include "hdl/net/bitmap.hpp"
 #include "hdl/util/id_string.hpp"
 
@@ -41,6 +44,31 @@ struct InstanceSpec {
     std::vector<ConnSpec> mConns;
 };
 
+// Width mismatch found during elaboration; the assign or binding was
+// skipped. Kept on the spec so lint can report it.
+struct WidthMismatch {
+    IdString mInstance;        // invalid for an assign
+    IdString mFormal;          // bound port (bindings only)
+    uint32_t mAssignIndex = 0; // decl assign index (assigns only)
+    uint32_t mExpected = 0;    // formal / LHS width
+    uint32_t mActual = 0;
+};
+
+// assign <bit> = 1'b0/1'b1. A directed source on the bit's own net: the
+// bit is not aliased into the tie nets, so unrelated tied-off wires stay
+// separate nets and a conflict on one does not reach the others.
+struct ConstDriver {
+    net::BitId mBit = 0;
+    bool mOne = false;
+    bool operator==(const ConstDriver&) const = default;
+};
+
+// One instantiation of a spec: instance mInstIndex of mParent.
+struct SpecUse {
+    const struct ModuleSpec* mParent = nullptr;
+    uint32_t mInstIndex = 0;
+};
+
 struct ModuleSpec {
     IdString mName;
     const ast::ModuleDecl* mDecl = nullptr; // back-pointer to AST
@@ -50,21 +78,51 @@ struct ModuleSpec {
 
     std::unordered_map<IdString, uint32_t, IdString::Hash> mPortIndex;
     std::unordered_map<IdString, uint32_t, IdString::Hash> mWireIndex;
+    // Filled by linkInstances.
+    std::unordered_map<IdString, uint32_t, IdString::Hash> mInstanceIndex;
+    // Where-used reverse edges, maintained by the parent's linkInstances
+    // (which only holds callees by const pointer, hence mutable).
+    mutable std::vector<SpecUse> mUsers;
+    // Instances of library cells, filled by linkInstances instead of
+    // mInstances when a CellLibrary is given.
+    PrimTable mPrims;
 
     ParamSpec mEnv;
 
     net::BitMap mBitMap;
+    InstanceTable mInstTable; // frozen view of mInstances, same rebuilds
+    FanoutIndex mFanout;      // rebuilt by linkInstances
+    // Assign entries from wireAssigns, binding entries from linkInstances.
+    std::vector<WidthMismatch> mWidthMismatches;
+    std::vector<ConstDriver> mConstDrivers; // filled by wireAssigns
+    // Filled by pruneDeadWires: declared wire index -> current index
+    // (kPrunedWire if removed; empty until the first prune), and the
+    // removed wires by name so lookups can tell "pruned" from "unknown".
+    static constexpr uint32_t kPrunedWire = UINT32_MAX;
+    std::vector<uint32_t> mWireRemap;
+    std::unordered_map<IdString, WireSpec, IdString::Hash> mPrunedWires;
+
+    // Set on a structurally merged duplicate: the entry keeps its key, name
+    // and params but no contents; lookups forward to the canonical spec.
+    ModuleSpec* mAliasOf = nullptr;
 
     int findPortIndex(IdString n) const;
     int findWireIndex(IdString n) const;
+    int findInstanceIndex(IdString n) const;
+    bool isPrunedWire(IdString n) const { return mPrunedWires.count(n) != 0; }
 
     net::BitId portBit(IdString name, uint32_t bitOff) const;
     net::BitId wireBit(IdString name, uint32_t bitOff) const;
+    // BitId of a flattened atom; constants map to the BitMap's tie bits,
+    // unknown owners to UINT32_MAX.
+    net::BitId atomBit(const BitAtom& a) const;
 
     void dumpLayout(std::ostream& os);
     void dumpConnectivity(std::ostream& os);
 
     std::string renderBit(net::BitId b) const;
+    // Approximate heap + inline footprint, excluding callees.
+    size_t memoryBytes() const;
 };
 
 // Library keyed by "name#paramSig"
@@ -0,0 +1,67 @@
+#pragma once
+// Transitive fan-in/fan-out cones across the hierarchy, without
+// flattening. A cone is a set of (scope, local net) pairs. Moving through
+// port bindings (into a child, or out to the parent) costs nothing; a leaf
+// module with no instances and no assigns is opaque and crossed as
+// all-inputs -> all-outputs, which costs one level. Primitive cells are
+// crossed along their arcs at the same cost.
+//
+// Each level is expanded breadth-first from a frontier. Successors of a
+// wide frontier are computed in parallel from read-only state, then
+// interned serially (new child scopes, visited bits).
+//
+// With a PortModelCache, non-opaque children are not entered: the cone
+// jumps from the child pin straight to the parent nets its port model
+// reaches, at no level cost. Pins inside such subtrees are not reported.
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "hdl/hier/scope.hpp"
+#include "hdl/net/connectivity.hpp"
+
+namespace hdl::elab::hier {
+
+enum class ConeDir { Fanin, Fanout };
+
+class PortModelCache;
+
+struct ConeOptions {
+    ConeDir mDir = ConeDir::Fanout;
+    uint32_t mMaxDepth = UINT32_MAX; // opaque leaf crossings
+    unsigned mThreads = 0;           // 0 = hardware concurrency
+    size_t mParallelMin = 4096;      // frontier size to go parallel
+    PortModelCache* mModels = nullptr; // abstract non-opaque children
+};
+
+// A leaf-cell pin crossed by the cone (its inputs for fan-out, outputs for
+// fan-in) or a top-level port where the cone leaves the design.
+struct ConePin {
+    ScopeHandle mScope = kRootScope;
+    uint32_t mPort = 0;
+    uint32_t mBit = 0; // LSB-first offset
+};
+
+struct ConeNet {
+    ScopeHandle mScope = kRootScope;
+    net::NetId mNet = 0;
+};
+
+struct ConeResult {
+    std::vector<ConeNet> mNets; // in visit order
+    std::vector<ConePin> mPins;
+    uint32_t mLevels = 0; // opaque crossings on the deepest path taken
+};
+
+// True for leaf modules traced as all-inputs -> all-outputs.
+bool isOpaqueLeaf(const ModuleSpec& spec);
+
+// Starts at local bit `bit` of `scope`'s spec. Starting on a pin of an
+// opaque leaf starts from the parent net bound to it. Specs must be frozen
+// and linked (FanoutIndex built).
+bool traceCone(ScopeTable& scopes, ScopeHandle scope, net::BitId bit,
+               const ConeOptions& opts, ConeResult& out,
+               std::ostream* diag = nullptr);
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,57 @@
+#pragma once
+// Constant propagation over the hierarchy. Within a module, values are
+// seeded per driven net: the tie-0/tie-1 nets (constant bindings) and the
+// net of every constant assign (ModuleSpec::mConstDrivers), so a conflict
+// stays on the net that is actually driven both ways. This pass adds what
+// the local drivers cannot see: values leaving children through output
+// ports and values carried across children's wire feedthroughs (port
+// models with opaque leaves cut).
+//
+// Values are two bitsets per spec over local nets ("may be 0", "may be
+// 1"); constant and conflict classification is word-wise over 64 nets at
+// a time. Specs are context-free, so a constant driven into a child's
+// input is seen in the parent but not pushed down into the child.
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab::hier {
+
+enum class ConstVal : uint8_t { Unknown, Zero, One, Conflict };
+const char* to_string(ConstVal v);
+
+struct SpecConsts {
+    std::vector<uint64_t> mKnown0; // bit n: local net n carries a 0
+    std::vector<uint64_t> mKnown1;
+    uint32_t mConstNets = 0;    // excluding the bare tie nets
+    uint32_t mConflictNets = 0; // both 0 and 1 reach the net
+
+    ConstVal of(net::NetId n) const {
+        uint64_t m = uint64_t(1) << (n & 63);
+        bool z = mKnown0[n >> 6] & m, o = mKnown1[n >> 6] & m;
+        return z ? (o ? ConstVal::Conflict : ConstVal::Zero)
+                 : (o ? ConstVal::One : ConstVal::Unknown);
+    }
+};
+
+class ConstTable {
+  public:
+    // Every spec reachable from top; specs must be frozen and linked.
+    explicit ConstTable(const ModuleSpec& top, std::ostream* diag = nullptr);
+
+    const SpecConsts& of(const ModuleSpec& spec) const {
+        return mConsts.at(&spec);
+    }
+    // Callees before callers; the top is last.
+    const std::vector<const ModuleSpec*>& order() const { return mOrder; }
+
+  private:
+    std::vector<const ModuleSpec*> mOrder;
+    std::unordered_map<const ModuleSpec*, SpecConsts> mConsts;
+};
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,74 @@
+#pragma once
+// Materialized flat view of a design: every leaf instance, pin (leaf port
+// bit) and global net as dense ids with CSR adjacency. Leaves are child
+// instances of specs with no instances and no primitives, and primitive
+// cells; a spec holding both contributes its child subtrees, then its
+// cells. Built per top-level subtree in parallel; id ranges come from
+// prefix sums of per-spec counts, so the result does not depend on the
+// thread count.
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+#include "hdl/hier/global_net.hpp"
+
+namespace hdl::elab::hier {
+
+// Leaf instance mIndex of mParent: an InstanceSpec, or a PrimTable entry
+// when mPrim.
+struct FlatLeaf {
+    const ModuleSpec* mParent = nullptr;
+    uint32_t mIndex = 0;
+    bool mPrim = false;
+
+    IdString name() const;
+    bool operator==(const FlatLeaf&) const = default;
+};
+
+struct FlatGraph {
+    // Leaf instances in depth-first order; pins of instance i are
+    // [mInstPinBase[i], mInstPinBase[i + 1]), one per callee port bit in
+    // BitId order (one per cell pin for primitives). An unconnected cell
+    // pin gets a net of its own, like an unbound child port.
+    std::vector<FlatLeaf> mInsts;
+    std::vector<uint32_t> mInstPinBase;
+    std::vector<uint32_t> mPinInst; // pin -> leaf instance
+    std::vector<uint32_t> mPinNet;  // pin -> net
+    // Nets that touch at least one pin, numbered by first pin.
+    std::vector<uint32_t> mNetPinOffsets; // CSR net -> pins
+    std::vector<uint32_t> mNetPins;
+
+    uint32_t instanceCount() const {
+        return static_cast<uint32_t>(mInsts.size());
+    }
+    uint32_t pinCount() const {
+        return static_cast<uint32_t>(mPinInst.size());
+    }
+    uint32_t netCount() const {
+        return mNetPinOffsets.empty()
+                 ? 0
+                 : static_cast<uint32_t>(mNetPinOffsets.size() - 1);
+    }
+    std::span<const uint32_t> pinsOf(uint32_t net) const {
+        return {mNetPins.data() + mNetPinOffsets[net],
+                mNetPins.data() + mNetPinOffsets[net + 1]};
+    }
+    size_t memoryBytes() const;
+    void clear() { *this = FlatGraph{}; }
+};
+
+struct FlatGraphOptions {
+    size_t mMemoryBudget = 0; // bytes; 0 = unlimited
+    unsigned mThreads = 0;    // 0 = hardware concurrency
+};
+
+// Returns false (and leaves `out` empty) when the graph would exceed the
+// memory budget or the hierarchy is malformed.
+bool buildFlatGraph(const ModuleSpec& top, GlobalNetResolver& resolver,
+                    const FlatGraphOptions& opts, FlatGraph& out,
+                    std::ostream* diag = nullptr);
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,86 @@
+#pragma once
+// Cross-hierarchy net resolution without flattening. Each specialization is
+// summarized once: its frozen local nets are merged through the children's
+// port bindings into "closed" classes, and every class keeps the list of
+// port bits it reaches. A bit at some scope is resolved by climbing through
+// the first of those ports that the parent binds, until a class no longer
+// leaves its module; that (scope, class) pair names the global net.
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/elaborate.hpp"
+#include "hdl/elab/spec.hpp"
+#include "hdl/hier/scope.hpp"
+
+namespace hdl::elab::hier {
+
+struct GlobalNetKey {
+    ScopeHandle mScope = kRootScope; // topmost scope the net reaches
+    net::NetId mClass = 0;           // closed class within that scope's spec
+
+    bool operator==(const GlobalNetKey& o) const {
+        return mClass == o.mClass && mScope == o.mScope;
+    }
+    bool operator!=(const GlobalNetKey& o) const { return !(*this == o); }
+};
+
+struct SpecNetSummary {
+    std::vector<net::NetId> mClassOf;   // local NetId -> closed class
+    std::vector<uint32_t> mExitOffsets; // CSR class -> port bits
+    std::vector<net::BitId> mExitBits;  // ascending within a class
+
+    uint32_t classCount() const {
+        return mExitOffsets.empty()
+                 ? 0
+                 : static_cast<uint32_t>(mExitOffsets.size() - 1);
+    }
+    bool hasExit(net::NetId c) const {
+        return mExitOffsets[c] != mExitOffsets[c + 1];
+    }
+    std::span<const net::BitId> exits(net::NetId c) const {
+        return {mExitBits.data() + mExitOffsets[c],
+                mExitBits.data() + mExitOffsets[c + 1]};
+    }
+};
+
+// Parent-side BitId bound to child port bit `childBit` of `inst`, or
+// UINT32_MAX when that port is unconnected; constants give the parent's tie
+// bits. `inst` must be an element of parent.mInstances; O(1) once the
+// parent's InstanceTable is built.
+net::BitId boundParentBit(const ModuleSpec& parent, const InstanceSpec& inst,
+                          net::BitId childBit);
+
+// Specs must be frozen (getOrCreateSpec does this) and linked. Summaries
+// are memoized per unique specialization; rebuild the resolver after
+// relinking.
+class GlobalNetResolver {
+  public:
+    explicit GlobalNetResolver(const ModuleSpec& top,
+                               std::ostream* diag = nullptr)
+        : mScopes(top)
+        , mDiag(diag) {}
+
+    // Handles in keys and arguments belong to this table.
+    ScopeTable& scopes() { return mScopes; }
+    const ScopeTable& scopes() const { return mScopes; }
+
+    // Global net of local bit `bit` in the spec of `scope`.
+    bool resolve(ScopeHandle scope, net::BitId bit, GlobalNetKey& out);
+    bool resolvePort(ScopeHandle scope, IdString port, uint32_t bitOff,
+                     GlobalNetKey& out);
+    // True when both pins resolve to the same global net.
+    bool sameNet(ScopeHandle a, net::BitId bitA, ScopeHandle b,
+                 net::BitId bitB);
+
+    const SpecNetSummary& summary(const ModuleSpec& spec);
+    size_t summaryCount() const { return mSummaries.size(); }
+
+  private:
+    ScopeTable mScopes;
+    std::ostream* mDiag = nullptr;
+    std::unordered_map<const ModuleSpec*, SpecNetSummary> mSummaries;
+};
+
+} // namespace hdl::elab::hier
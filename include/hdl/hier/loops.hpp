@@ -0,0 +1,45 @@
+#pragma once
+// Combinational loop detection. Each spec gets a directed bit-level graph:
+// assign RHS bit -> LHS bit, plus child pin -> child pin edges from the
+// children's port models (opaque leaves are cut, so register feedback
+// through black boxes is not a loop) and from primitive cell arcs.
+// Strongly connected components are found with Pearce's iterative
+// algorithm, so depth is bounded by memory, not the call stack.
+//
+// Loops through a child are found in the parent via the child's model;
+// loops wholly inside a child are found once, in the child's spec.
+// Modules run in parallel; each reserves its working set (about 4 bytes
+// per edge plus 21 per bit) from a shared budget before building.
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab::hier {
+
+struct LoopOptions {
+    size_t mMemoryBudget = size_t(1) << 30; // bytes across running modules
+    unsigned mThreads = 0;                  // 0 = hardware concurrency
+};
+
+struct ModuleLoops {
+    const ModuleSpec* mSpec = nullptr;
+    uint64_t mEdges = 0;
+    bool mSkipped = false; // working set alone exceeds the budget
+    // Each loop's local bits, ascending; loops ordered by first bit.
+    std::vector<std::vector<net::BitId>> mLoops;
+};
+
+// Bytes findCombLoops reserves for a graph of this size.
+size_t loopWorkingSet(uint64_t bits, uint64_t edges);
+
+// One entry per spec, in input order. Specs must be frozen and linked.
+// Returns false if any module was skipped.
+bool findCombLoops(std::span<const ModuleSpec* const> specs,
+                   const LoopOptions& opts, std::vector<ModuleLoops>& out,
+                   std::ostream* diag = nullptr);
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,53 @@
+#pragma once
+// Name-based hierarchical paths: "u_core/u_rep" names a scope and
+// "u_core/u_rep.p_in[5]" a pin (port bit, by declared index). A leading
+// segment equal to the top module's name is accepted and ignored. Each
+// segment is one probe of ModuleSpec::mInstanceIndex, and every resolved
+// prefix is memoized, so repeated lookups under a common prefix only pay
+// for the segments after it. Primitive cells have no scope, so their pins
+// cannot be named here (see hdl/elab/cells.hpp).
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "hdl/elab/elaborate.hpp"
+#include "hdl/hier/scope.hpp"
+
+namespace hdl::elab::hier {
+
+struct HierPinRef {
+    PinKey mPin;
+    uint32_t mBitOff = 0;    // LSB-first offset within the port
+    bool mWholePort = true; // no [index] given; mBitOff is 0
+};
+
+class PathResolver {
+  public:
+    explicit PathResolver(const ModuleSpec& top, std::ostream* diag = nullptr)
+        : mScopes(top)
+        , mDiag(diag) {}
+
+    void setDiag(std::ostream* diag) { mDiag = diag; }
+    ScopeTable& scopes() { return mScopes; }
+    const ScopeTable& scopes() const { return mScopes; }
+
+    // kInvalidScope (with a diagnostic) when a segment does not resolve.
+    ScopeHandle resolveScope(std::string_view path);
+    bool resolvePin(std::string_view path, HierPinRef& out);
+
+    // Canonical name forms, inverse of the resolvers above.
+    std::string scopePath(ScopeHandle h) const;
+    std::string pinPath(const HierPinRef& pin) const;
+
+    size_t cacheSize() const { return mCache.size(); }
+
+  private:
+    ScopeTable mScopes;
+    std::ostream* mDiag = nullptr;
+    std::unordered_map<std::string, ScopeHandle> mCache; // prefix -> scope
+};
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,66 @@
+#pragma once
+// Port-to-port feedthrough models. For every port bit of a specialization
+// the model lists which port bits it reaches combinationally-structurally
+// (same net, or through children's models), forward (input -> output) and
+// reverse (output -> input), as sorted BitId range lists. Port bits are
+// BitIds [0, portBits) since ports are allocated first.
+//
+// Models are computed bottom-up, once per unique spec, and let tracing jump
+// across a whole subtree in O(ports) instead of walking its contents.
+// Opaque leaves (see isOpaqueLeaf) connect every input to every output.
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab::hier {
+
+struct BitRange {
+    net::BitId mLo = 0; // [mLo, mHi)
+    net::BitId mHi = 0;
+};
+
+struct PortModel {
+    uint32_t mPortBits = 0;
+    bool mFull = false; // every input bit reaches every output bit
+    std::vector<uint32_t> mFwdOffsets; // CSR port bit -> reached outputs
+    std::vector<BitRange> mFwd;
+    std::vector<uint32_t> mRevOffsets; // CSR port bit -> reaching inputs
+    std::vector<BitRange> mRev;
+
+    std::span<const BitRange> reach(net::BitId portBit, bool forward) const {
+        const auto& off = forward ? mFwdOffsets : mRevOffsets;
+        const auto& r = forward ? mFwd : mRev;
+        return {r.data() + off[portBit], r.data() + off[portBit + 1]};
+    }
+    size_t arcCount() const;
+    size_t memoryBytes() const;
+};
+
+class PortModelCache {
+  public:
+    // With cutOpaque, opaque leaves get empty models (black boxes such as
+    // registers break paths) instead of all-to-all, and arc-less cells are
+    // skipped; cell arcs are kept either way.
+    explicit PortModelCache(bool cutOpaque = false)
+        : mCutOpaque(cutOpaque) {}
+
+    // Specs must be frozen and linked. Recursion depth is the hierarchy
+    // depth.
+    const PortModel& model(const ModuleSpec& spec);
+    // Already computed model or nullptr; safe for concurrent readers.
+    const PortModel* find(const ModuleSpec& spec) const {
+        auto it = mModels.find(&spec);
+        return it == mModels.end() ? nullptr : &it->second;
+    }
+    size_t size() const { return mModels.size(); }
+
+  private:
+    bool mCutOpaque = false;
+    std::unordered_map<const ModuleSpec*, PortModel> mModels;
+};
+
+} // namespace hdl::elab::hier
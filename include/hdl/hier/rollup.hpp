@@ -0,0 +1,45 @@
+#pragma once
+// Per-specialization subtree totals. Specs are shared by every instance of
+// the same module/parameter set, so totals are computed once per unique
+// spec in reverse topological order (callees first) and a flattened
+// design of any size is sized in time linear in the number of specs.
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab::hier {
+
+// Totals strictly below one instance of a spec, plus its own bits/nets.
+struct SpecRollup {
+    uint64_t mInstances = 0;     // all descendant instances
+    uint64_t mLeafInstances = 0; // primitives, callees with neither
+    uint64_t mLeafPins = 0;      // port bits over those leaf instances
+    uint64_t mBits = 0;          // flattened bits, own included
+    uint64_t mNets = 0;          // local nets summed over every scope
+    uint32_t mDepth = 0;         // longest instance chain below
+};
+
+class RollupTable {
+  public:
+    // Visits every spec reachable from top; instance cycles are reported
+    // and the back edge is ignored.
+    explicit RollupTable(const ModuleSpec& top, std::ostream* diag = nullptr);
+
+    // spec must be reachable from the top passed to the constructor.
+    const SpecRollup& of(const ModuleSpec& spec) const {
+        return mRollups.at(&spec);
+    }
+    // Callees before callers; the top is last.
+    const std::vector<const ModuleSpec*>& order() const { return mOrder; }
+    size_t specCount() const { return mOrder.size(); }
+
+  private:
+    std::vector<const ModuleSpec*> mOrder;
+    std::unordered_map<const ModuleSpec*, SpecRollup> mRollups;
+};
+
+} // namespace hdl::elab::hier
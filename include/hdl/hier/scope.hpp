@@ -0,0 +1,77 @@
+#pragma once
+// Hierarchical scope paths interned into 32-bit handles. The table is a
+// parent-pointer tree: each handle records its parent, the instance index
+// it was reached through and the spec it elaborates to, so walking up or
+// asking for a scope's module is O(1). Child lookups are memoized by
+// (parent, instance index).
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab::hier {
+
+// Explicit path of child instance indices from the top. Use ScopeTable to
+// turn it into a handle.
+struct ScopeId {
+    std::vector<uint32_t> mPath; // child instance indices along hierarchy
+    std::string toString() const {
+        if (mPath.empty()) return "<root>";
+        std::string s;
+        for (size_t i = 0; i < mPath.size(); ++i) {
+            if (i) s.push_back('/');
+            s += std::to_string(mPath[i]);
+        }
+        return s;
+    }
+};
+
+using ScopeHandle = uint32_t;
+inline constexpr ScopeHandle kRootScope = 0;
+inline constexpr ScopeHandle kInvalidScope = UINT32_MAX;
+
+class ScopeTable {
+  public:
+    explicit ScopeTable(const ModuleSpec& top) {
+        mEntries.push_back(Entry{kInvalidScope, 0, 0, &top});
+    }
+
+    // Scope reached through instance `instIndex` of `parent`, interned on
+    // first use; kInvalidScope when the index or its callee is missing.
+    ScopeHandle child(ScopeHandle parent, uint32_t instIndex);
+    ScopeHandle intern(const ScopeId& path, std::ostream* diag = nullptr);
+
+    ScopeHandle parent(ScopeHandle h) const { return mEntries[h].mParent; }
+    uint32_t instanceIndex(ScopeHandle h) const {
+        return mEntries[h].mInstIndex;
+    }
+    uint32_t depth(ScopeHandle h) const { return mEntries[h].mDepth; }
+    const ModuleSpec& spec(ScopeHandle h) const { return *mEntries[h].mSpec; }
+    // Instance in the parent's spec that h was reached through; nullptr for
+    // the root.
+    const InstanceSpec* instance(ScopeHandle h) const {
+        const Entry& e = mEntries[h];
+        if (e.mParent == kInvalidScope) return nullptr;
+        return &mEntries[e.mParent].mSpec->mInstances[e.mInstIndex];
+    }
+
+    ScopeId path(ScopeHandle h) const;
+    std::string toString(ScopeHandle h) const { return path(h).toString(); }
+    size_t size() const { return mEntries.size(); }
+
+  private:
+    struct Entry {
+        ScopeHandle mParent = kInvalidScope;
+        uint32_t mInstIndex = 0;
+        uint32_t mDepth = 0;
+        const ModuleSpec* mSpec = nullptr;
+    };
+    std::vector<Entry> mEntries;
+    std::unordered_map<uint64_t, ScopeHandle> mChildren; // parent<<32 | idx
+};
+
+} // namespace hdl::elab::hier
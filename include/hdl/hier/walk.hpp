@@ -0,0 +1,41 @@
+#pragma once
+// Lazy pre-order walk over instance paths. The walk keeps one small frame
+// per hierarchy level, so memory is O(depth) regardless of how many
+// instances are visited. Only mInstances are walked; primitive cells
+// (ModuleSpec::mPrims) have no scope and are not yielded.
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+#include "hdl/hier/scope.hpp"
+#include "hdl/util/generator.hpp"
+
+namespace hdl::elab::hier {
+
+struct InstanceVisit {
+    ScopeHandle mScope = kInvalidScope;  // the instance's own scope
+    ScopeHandle mParent = kInvalidScope; // scope that contains it
+    const InstanceSpec* mInst = nullptr;
+    uint32_t mIndex = 0; // index in the parent spec's mInstances
+    uint32_t mDepth = 0; // 1 for instances of the start scope's spec
+};
+
+struct WalkOptions {
+    uint32_t mMaxDepth = UINT32_MAX; // do not yield deeper instances
+    // Instances of these modules are yielded but not descended into.
+    std::vector<IdString> mPruneModules;
+    // Optional: return true to yield an instance without descending.
+    std::function<bool(const InstanceVisit&)> mPrune;
+    // Intern a ScopeHandle for every visited instance. Turn off for pure
+    // streaming; mScope/mParent are then kInvalidScope below the start.
+    bool mInternScopes = true;
+};
+
+// The table and the specs it refers to must outlive the generator.
+Generator<InstanceVisit> walkInstances(ScopeTable& scopes,
+                                       ScopeHandle from = kRootScope,
+                                       WalkOptions opts = {});
+
+} // namespace hdl::elab::hier
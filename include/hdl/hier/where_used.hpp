@@ -0,0 +1,39 @@
+#pragma once
+// Where-used queries over the ModuleSpec::mUsers reverse edges. Paths are
+// enumerated upwards from the target and only along parents that can
+// reach the top, so every explored branch yields output.
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "hdl/elab/spec.hpp"
+#include "hdl/hier/scope.hpp"
+
+namespace hdl::elab::hier {
+
+// Direct users of each spec, concatenated in input order.
+std::vector<SpecUse> whereUsed(std::span<const ModuleSpec* const> specs);
+
+class RootPaths {
+  public:
+    RootPaths(const ModuleSpec& top, const ModuleSpec& target);
+
+    // Number of distinct instance paths from top to target (saturating).
+    uint64_t count() const;
+    // Calls fn with each path (top-first instance indices); stops early
+    // when fn returns false. Returns the number of paths emitted.
+    size_t forEach(const std::function<bool(const ScopeId&)>& fn) const;
+
+  private:
+    bool reachesTop(const ModuleSpec* s) const;
+
+    const ModuleSpec& mTop;
+    const ModuleSpec& mTarget;
+    // Memo for reachesTop(): 1 yes, 0 no, -1 in progress.
+    mutable std::unordered_map<const ModuleSpec*, int8_t> mReach;
+};
+
+} // namespace hdl::elab::hier
@@ -14,28 +14,45 @@ struct ModuleSpec;
 namespace hdl::net {
 
 struct BitOwnerRef {
-    enum class Kind { Port, Wire } mKind = Kind::Wire;
-    uint32_t mOwnerIndex = 0; // port or wire index
+    enum class Kind { Port, Wire, Tie } mKind = Kind::Wire;
+    uint32_t mOwnerIndex = 0; // port or wire index; 0/1 for a tie bit
     uint32_t mBitOffset = 0;  // LSB-first offset within owner
 };
 
+// One entry per port/wire: the owner of every bit in [mBase, next mBase).
+struct BitOwnerRange {
+    BitId mBase = 0;
+    BitOwnerRef::Kind mKind = BitOwnerRef::Kind::Wire;
+    uint32_t mOwnerIndex = 0;
+};
+
 struct BitMap {
     Connectivity mConn;
-    std::vector<BitId> mPortBase;         // base BitId per port index
-    std::vector<BitId> mWireBase;         // base BitId per wire index
-    std::vector<BitOwnerRef> mReverseMap; // size == mConn.size()
+    std::vector<BitId> mPortBase;            // base BitId per port index
+    std::vector<BitId> mWireBase;            // base BitId per wire index
+    std::vector<BitOwnerRange> mOwnerRanges; // sorted by mBase
+    // Tie-0 / tie-1 bits, allocated after the wires. Instance pins bound
+    // to constants point at them; constant assigns are recorded as
+    // directed drivers instead (ModuleSpec::mConstDrivers).
+    BitId mTieBase = 0;
 
+    // Keeps the selected union-find mode across rebuilds.
     void reset() {
-        mConn = Connectivity{};
+        mConn = Connectivity{mConn.mode()};
         mPortBase.clear();
         mWireBase.clear();
-        mReverseMap.clear();
+        mOwnerRanges.clear();
+        mTieBase = 0;
     }
 
     // Build allocation and reverse map from a ModuleSpec's declared
-    // ports/wires.
+    // ports/wires. O(ports + wires).
     void build(const elab::ModuleSpec& spec);
 
+    // Reverse lookup by binary search over mOwnerRanges.
+    bool ownerOf(BitId g, BitOwnerRef& out) const;
+    size_t memoryBytes() const;
+
     // Addressing
     BitId portBit(uint32_t pIdx, uint32_t bitOff) const {
         return mPortBase[pIdx] + bitOff;
@@ -43,10 +60,24 @@ struct BitMap {
     BitId wireBit(uint32_t wIdx, uint32_t bitOff) const {
         return mWireBase[wIdx] + bitOff;
     }
+    BitId tieBit(bool one) const { return mTieBase + (one ? 1 : 0); }
+    bool isTie(BitId b) const { return b - mTieBase < 2; }
 
     // Connectivity ops
+    // Use UnionFindMode::Concurrent when alias() is driven from many threads,
+    // calling beginConcurrent() before they start.
+    void setUnionFindMode(UnionFindMode mode) { mConn.setMode(mode); }
+    void beginConcurrent() { mConn.beginConcurrent(); }
     void alias(BitId a, BitId b) { mConn.alias(a, b); }
     net::NetId netId(BitId a) { return mConn.netId(a); }
+    // Freeze after the last alias(); netOf() is then const and O(1).
+    void freeze() { mConn.freeze(); }
+    bool frozen() const { return mConn.frozen(); }
+    net::NetId netOf(BitId a) const { return mConn.netOf(a); }
+    net::NetId netCount() const { return mConn.netCount(); }
+    // Cached net -> bits index, rebuilt lazily after alias().
+    NetGroups netGroups() { return mConn.groups(); }
+    NetGroups netGroups() const { return mConn.groups(); }
 
     // Rendering using spec
     std::string renderBit(const elab::ModuleSpec& spec, BitId g) const;
@@ -3,37 +3,206 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <ostream>
+#include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "hdl/util/spill.hpp"
+
 namespace hdl::net {
 
 using BitId = uint32_t;
 using NetId = uint32_t;
 
+// Union-find flavour backing a Connectivity. Sequential is union by rank
+// with path compression; Concurrent allows unite() from many threads at once.
+enum class UnionFindMode { Sequential, Concurrent };
+
+const char* to_string(UnionFindMode m);
+
+// Sparse storage: parent/rank live in fixed-size pages that are materialized
+// only when one of their bits is first united. Bits on absent pages are
+// implicit singleton roots, so growing the node set is O(1).
+// The saving is limited to the aliasing phase: freeze() still builds dense
+// per-bit arrays (netOf plus the CSR index, 12 bytes per bit), and every
+// elaborated spec is frozen, so a finished spec pays for untouched bits.
 struct UnionFindBits {
+    static constexpr uint32_t kPageBits = 12;
+    static constexpr uint32_t kPageSize = 1u << kPageBits;
+
+    // Page tables (nullptr == absent) over storage owned by mPageStore.
+    std::vector<BitId*> mParentPages;
+    std::vector<uint8_t*> mRankPages;
+    BitId mSize = 0;
+
+    UnionFindBits() = default;
+    UnionFindBits(const UnionFindBits& o);
+    UnionFindBits& operator=(const UnionFindBits& o);
+    UnionFindBits(UnionFindBits&&) = default;
+    UnionFindBits& operator=(UnionFindBits&&) = default;
+
+    BitId addNode();
+    void ensureSize(BitId n);
+    BitId size() const { return mSize; }
+    BitId find(BitId x);
+    void unite(BitId a, BitId b);
+
+    BitId parent(BitId x) const {
+        uint32_t pg = x >> kPageBits;
+        if (pg >= mParentPages.size() || !mParentPages[pg]) return x;
+        return mParentPages[pg][x & (kPageSize - 1)];
+    }
+    // Copy every parent into out[0..size()) and write flattened roots back.
+    void snapshotParents(BitId* out) const;
+    void storeParents(const BitId* roots);
+    size_t pageCount() const;
+    size_t memoryBytes() const;
+
+  private:
+    struct Page {
+        BitId mParent[kPageSize];
+        uint8_t mRank[kPageSize];
+    };
+    std::vector<std::unique_ptr<Page>> mPageStore;
+
+    void touch(BitId x);
+};
+
+// Lock-free variant: roots are linked by index priority (the larger root
+// points at the smaller one) with a single CAS, so parent chains strictly
+// decrease and no cycle can form. find() uses path halving with one CAS
+// attempt per step and never retries, which keeps it wait-free.
+// Growing the node set (addNode/ensureSize) is not thread-safe.
+// Storage is dense: every page would have to exist before threads start, so
+// nothing is gained from the sparse layout here.
+struct ConcurrentUnionFindBits {
     std::vector<BitId> mParent;
-    std::vector<uint32_t> mRank;
 
     BitId addNode();
     void ensureSize(BitId n);
     BitId find(BitId x);
     void unite(BitId a, BitId b);
+    size_t memoryBytes() const { return mParent.capacity() * sizeof(BitId); }
+};
+
+// Read-only view over a frozen net -> bits index (CSR). Iterating yields one
+// span of ascending BitIds per net, in NetId order.
+class NetGroups {
+  public:
+    class Iterator {
+      public:
+        Iterator(const NetGroups* g, NetId n)
+            : mGroups(g)
+            , mNet(n) {}
+        std::span<const BitId> operator*() const { return (*mGroups)[mNet]; }
+        Iterator& operator++() {
+            ++mNet;
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const { return mNet != o.mNet; }
+        NetId net() const { return mNet; }
+
+      private:
+        const NetGroups* mGroups;
+        NetId mNet;
+    };
+
+    NetGroups() = default;
+    NetGroups(const uint32_t* offsets, const BitId* bits, NetId count)
+        : mOffsets(offsets)
+        , mBits(bits)
+        , mCount(count) {}
+
+    NetId size() const { return mCount; }
+    bool empty() const { return mCount == 0; }
+    std::span<const BitId> operator[](NetId n) const {
+        return {mBits + mOffsets[n], mBits + mOffsets[n + 1]};
+    }
+    Iterator begin() const { return {this, 0}; }
+    Iterator end() const { return {this, mCount}; }
+
+  private:
+    const uint32_t* mOffsets = nullptr;
+    const BitId* mBits = nullptr;
+    NetId mCount = 0;
 };
 
 struct Connectivity {
     UnionFindBits mUf;
+    ConcurrentUnionFindBits mCuf;
+    UnionFindMode mMode = UnionFindMode::Sequential;
     BitId mNextId = 0;
 
+    // Frozen numbering, valid while mFrozen. NetIds are dense (0..N-1) and
+    // canonical: nets are numbered in order of their smallest BitId.
+    // Spillable; see hdl/util/spill.hpp. Once mNetOf is spilled, a
+    // Sequential freeze() drops the union-find pages as well (mUfReleased):
+    // the frozen index holds the whole partition, and the next alias(),
+    // allocRange(), setMode() or freeze() rebuilds them in O(size()).
+    // Concurrent mode keeps its parent array, so a parallel alias() never
+    // has to rebuild it.
+    bool mFrozen = false;
+    bool mUfReleased = false;
+    FrozenArray<NetId> mNetOf;         // BitId -> NetId, size()
+    FrozenArray<uint32_t> mNetOffsets; // CSR offsets, netCount() + 1
+    FrozenArray<BitId> mNetBits;       // bits grouped by net, ascending
+
+    Connectivity() = default;
+    explicit Connectivity(UnionFindMode mode)
+        : mMode(mode) {}
+
+    // Switch the backing union-find; the current partition is preserved.
+    void setMode(UnionFindMode mode);
+    UnionFindMode mode() const { return mMode; }
+
+    // O(1) in Sequential mode; the bits start as implicit singletons.
     BitId allocRange(uint32_t width);
     BitId size() const;
+    size_t memoryBytes() const;
+    // Thread-safe in Concurrent mode once all ranges are allocated and
+    // beginConcurrent() has run; a Concurrent alias() then writes nothing
+    // but the union-find. Sequential alias() invalidates the frozen
+    // numbering itself.
     void alias(BitId a, BitId b);
+    // Start a parallel alias() phase: drops the frozen numbering once, up
+    // front. allocRange() does the same, so a fresh build needs neither.
+    void beginConcurrent() { mFrozen = false; }
+    // Dense NetId of a bit; freezes first if needed.
     NetId netId(BitId id);
-    std::vector<std::vector<BitId>> collectGroups();
+
+    // Flatten every parent pointer and (re)build the frozen numbering and
+    // the net -> bits index. No alias() may run concurrently.
+    void freeze();
+    bool frozen() const { return mFrozen; }
+    // Frozen queries: O(1), read-only, safe from many threads.
+    NetId netCount() const {
+        return mNetOffsets.empty()
+                 ? 0
+                 : static_cast<NetId>(mNetOffsets.size() - 1);
+    }
+    NetId netOf(BitId id) const { return mNetOf[id]; }
+    const FrozenArray<NetId>& netOfArray() const { return mNetOf; }
+    const FrozenArray<uint32_t>& netOffsets() const { return mNetOffsets; }
+    const FrozenArray<BitId>& netBits() const { return mNetBits; }
+    // Net -> bits index; freezes first if needed. The view stays valid until
+    // the next alias() or allocRange().
+    NetGroups groups();
+    // Frozen only.
+    NetGroups groups() const {
+        return {mNetOffsets.data(), mNetBits.data(), netCount()};
+    }
+    std::span<const BitId> bitsOf(NetId n) const {
+        const BitId* bits = mNetBits.data();
+        return {bits + mNetOffsets[n], bits + mNetOffsets[n + 1]};
+    }
     void dump(std::ostream& os,
               const std::function<std::string(BitId)>& renderBit);
+
+  private:
+    void releaseUnionFind();
+    void restoreUnionFind();
 };
 
-} // namespace hdl::net
\ No newline at end of file
+} // namespace hdl::net
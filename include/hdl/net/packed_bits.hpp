@@ -0,0 +1,88 @@
+#pragma once
+// Run/delta-compressed BitId sequences. Connection bits are mostly buses
+// (runs of consecutive ids), repeated ties or open pins, or ids close to
+// their neighbours, so the array is cut into fixed blocks of kBlock values
+// and each block is stored in the smallest of:
+//
+//   Stride : base + k * stride, no payload (runs, repeats, reversed buses)
+//   For8   : base + 8-bit offset
+//   For16  : base + 16-bit offset
+//   Delta8 : 8-bit signed difference to the previous value
+//   Raw    : 32-bit values
+//
+// The coded modes are patched: a value that does not fit (a clock or reset
+// net among local ones, an open pin, the jump to a distant bus) takes the
+// escape code and is stored verbatim, so a few strays do not force a block
+// to Raw. Fixed-size blocks keep random access O(1). Frame-of-reference
+// blocks decode with one pass over their codes plus a short patch loop;
+// delta blocks with a running sum.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "hdl/net/connectivity.hpp"
+
+namespace hdl::net {
+
+class PackedBitArray {
+  public:
+    static constexpr uint32_t kBlock = 32;
+    enum class Mode : uint8_t { Stride, For8, For16, Delta8, Raw };
+
+    class Iterator {
+      public:
+        Iterator(const PackedBitArray* a, size_t i)
+            : mArray(a)
+            , mIndex(i) {}
+        BitId operator*() {
+            size_t b = mIndex / kBlock;
+            if (b != mBlock) {
+                mArray->decodeBlock(b, mBuf);
+                mBlock = b;
+            }
+            return mBuf[mIndex % kBlock];
+        }
+        Iterator& operator++() {
+            ++mIndex;
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const { return mIndex != o.mIndex; }
+
+      private:
+        const PackedBitArray* mArray;
+        size_t mIndex;
+        size_t mBlock = SIZE_MAX;
+        BitId mBuf[kBlock];
+    };
+
+    PackedBitArray() = default;
+    explicit PackedBitArray(std::span<const BitId> values);
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    BitId operator[](size_t i) const;
+    // Writes values [first, first + count) to out.
+    void decode(size_t first, size_t count, BitId* out) const;
+    // Writes the (up to kBlock) values of block b to out.
+    uint32_t decodeBlock(size_t b, BitId* out) const;
+    Iterator begin() const { return {this, 0}; }
+    Iterator end() const { return {this, mSize}; }
+
+    size_t blockCount() const { return mModes.size(); }
+    Mode mode(size_t b) const { return mModes[b]; }
+    size_t memoryBytes() const;
+
+  private:
+    size_t mSize = 0;
+    std::vector<Mode> mModes;
+    std::vector<BitId> mBase;
+    std::vector<uint32_t> mAux; // stride, or index into the payload
+    std::vector<uint32_t> mExc; // first patch value in mP32 (coded modes)
+    std::vector<uint8_t> mP8;
+    std::vector<uint16_t> mP16;
+    std::vector<uint32_t> mP32;
+};
+
+} // namespace hdl::net
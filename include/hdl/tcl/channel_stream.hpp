@@ -0,0 +1,51 @@
+#pragma once
+// std::ostream adaptor over a Tcl_Channel so large reports can be streamed
+// instead of being built up as one interpreter result.
+
+#include <array>
+#include <ostream>
+#include <streambuf>
+
+#include <tcl.h>
+
+namespace hdl::tcl {
+
+class ChannelBuf : public std::streambuf {
+  public:
+    explicit ChannelBuf(Tcl_Channel chan)
+        : mChan(chan) {
+        setp(mBuf.data(), mBuf.data() + mBuf.size());
+    }
+    ~ChannelBuf() override { sync(); }
+
+    // False once a write to the channel failed.
+    bool ok() const { return mOk; }
+
+  protected:
+    int_type overflow(int_type ch) override {
+        if (!flushBuf()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    int sync() override {
+        if (!flushBuf()) return -1;
+        return Tcl_Flush(mChan) == TCL_OK ? 0 : -1;
+    }
+
+  private:
+    bool flushBuf() {
+        int n = static_cast<int>(pptr() - pbase());
+        if (n > 0 && Tcl_WriteChars(mChan, pbase(), n) < 0) mOk = false;
+        setp(mBuf.data(), mBuf.data() + mBuf.size());
+        return mOk;
+    }
+
+    Tcl_Channel mChan;
+    std::array<char, 1 << 16> mBuf;
+    bool mOk = true;
+};
+
+} // namespace hdl::tcl
@@ -12,6 +12,8 @@
 
 #include "hdl/elab/elaborate.hpp"
 #include "hdl/elab/spec.hpp"
+#include "hdl/hier/path.hpp"
+#include "hdl/hier/port_model.hpp"
 #include "hdl/util/id_string.hpp"
 
 namespace hdl::tcl {
@@ -22,17 +24,29 @@ struct SelRef {
     IdString mName;    // port/wire name (interned)
 };
 
+// Hierarchical pin below a spec, kept in canonical path form
+// ("u_core/u_rep.p_in[5]") so it survives relinking.
+struct SelPin {
+    IdString mSpecKey;
+    std::string mPath;
+    bool operator==(const SelPin& o) const {
+        return mSpecKey == o.mSpecKey && mPath == o.mPath;
+    }
+};
+
 struct Selection {
     IdString mPrimaryKey;
     std::vector<IdString> mModuleKeys;
     std::vector<SelRef> mPorts;
     std::vector<SelRef> mWires;
+    std::vector<SelPin> mPins;
 
     void clearAll() {
         mPrimaryKey = IdString();
         mModuleKeys.clear();
         mPorts.clear();
         mWires.clear();
+        mPins.clear();
     }
     bool hasModuleKey(IdString key) const {
         for (auto& k : mModuleKeys)
@@ -57,6 +71,11 @@ struct Selection {
                          mWires.end(),
                          [&](const SelRef& r) { return r.mSpecKey == key; }),
           mWires.end());
+        mPins.erase(
+          std::remove_if(mPins.begin(),
+                         mPins.end(),
+                         [&](const SelPin& r) { return r.mSpecKey == key; }),
+          mPins.end());
     }
     bool hasPort(const SelRef& ref) const {
         for (auto& r : mPorts)
@@ -94,6 +113,16 @@ struct Selection {
                                     }),
                      mWires.end());
     }
+    bool hasPin(const SelPin& ref) const {
+        return std::find(mPins.begin(), mPins.end(), ref) != mPins.end();
+    }
+    void addPin(const SelPin& ref) {
+        if (!hasPin(ref)) mPins.push_back(ref);
+    }
+    void removePin(const SelPin& ref) {
+        mPins.erase(std::remove(mPins.begin(), mPins.end(), ref),
+                    mPins.end());
+    }
 };
 
 class Console {
@@ -173,6 +202,14 @@ class Console {
                                       const elab::ParamSpec& env,
                                       IdString* outKey = nullptr);
     elab::ModuleSpec* currentPrimarySpec();
+    // Memoizing name-path resolver rooted at a spec; dropped on relink.
+    elab::hier::PathResolver* pathResolver(IdString key);
+    // Port feedthrough models shared by all specs; dropped on relink.
+    elab::hier::PortModelCache& portModels() { return mPortModels; }
+    // Call after anything that relinks or replaces specs.
+    void dropDerivedCaches();
+    // Primitive cells used when linking; load-cells relinks every spec.
+    elab::CellLibrary& cells() { return mCells; }
 
     bool resolvePortName(const elab::ModuleSpec& spec, const std::string& tok,
                          IdString& out) const;
@@ -226,6 +263,12 @@ class Console {
     const elab::ModuleDeclLib& mDeclLib;
     Selection mSel;
     std::ostream& mDiag;
+    std::unordered_map<IdString,
+                       std::unique_ptr<elab::hier::PathResolver>,
+                       IdString::Hash>
+      mPathResolvers;
+    elab::hier::PortModelCache mPortModels;
+    elab::CellLibrary mCells;
 
     std::vector<UndoEntry> mUndo;
     std::vector<UndoEntry> mRedo;
@@ -0,0 +1,101 @@
+#pragma once
+// Minimal C++20 generator: a lazily evaluated, single-pass input range
+// backed by a coroutine. Values are produced on demand with co_yield and
+// referenced (not copied) by the iterator.
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace hdl {
+
+template <typename T>
+class Generator {
+  public:
+    struct promise_type {
+        const T* mValue = nullptr;
+        std::exception_ptr mError;
+
+        Generator get_return_object() {
+            return Generator{Handle::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const T& v) noexcept {
+            mValue = std::addressof(v);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { mError = std::current_exception(); }
+        // Generators cannot co_await.
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+
+        iterator() = default;
+        explicit iterator(Handle h)
+            : mH(h) {}
+
+        reference operator*() const { return *mH.promise().mValue; }
+        pointer operator->() const { return mH.promise().mValue; }
+        iterator& operator++() {
+            advance(mH);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const {
+            return !mH || mH.done();
+        }
+
+      private:
+        Handle mH;
+    };
+
+    Generator() = default;
+    Generator(Generator&& o) noexcept
+        : mH(std::exchange(o.mH, {})) {}
+    Generator& operator=(Generator&& o) noexcept {
+        if (this != &o) {
+            if (mH) mH.destroy();
+            mH = std::exchange(o.mH, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (mH) mH.destroy();
+    }
+
+    // Single pass: begin() runs the body up to the first co_yield.
+    iterator begin() {
+        if (mH) advance(mH);
+        return iterator{mH};
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+  private:
+    explicit Generator(Handle h)
+        : mH(h) {}
+
+    static void advance(Handle h) {
+        h.resume();
+        if (h.done() && h.promise().mError)
+            std::rethrow_exception(h.promise().mError);
+    }
+
+    Handle mH;
+};
+
+} // namespace hdl
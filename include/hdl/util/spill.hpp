@@ -0,0 +1,159 @@
+#pragma once
+// Out-of-core storage for large frozen arrays (connection bits, fanout
+// CSR, frozen net maps). When the global SpillStore is configured with a
+// scratch directory, arrays of at least mMinBytes are written to an
+// unlinked scratch file and mapped read-only; the OS pages them in on
+// demand. The store keeps an estimate of the mapped bytes in use under a
+// resident budget: touching a cold region faults it in, and the least
+// recently touched regions are dropped with madvise(MADV_DONTNEED) until
+// the estimate fits. Dropping pages never invalidates pointers; the pages
+// are simply re-read from the file.
+//
+// Unconfigured (the default), FrozenArray is a std::vector plus one null
+// pointer test per access.
+//
+// Scope: only FrozenArray contents spill. A Connectivity whose net map is
+// spilled drops its union-find pages at freeze and rebuilds them on the
+// next alias. The builder view (ModuleSpec::mInstances and its ConnSpec
+// bit vectors) stays on the heap: linking, editing, walks and dumps still
+// read it, so a spilled module keeps roughly one heap copy of its pin bits.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace hdl {
+
+struct SpillOptions {
+    std::string mDir;                       // empty: spilling off
+    size_t mBudget = size_t(256) << 20;     // resident estimate, bytes
+    size_t mMinBytes = size_t(1) << 20;     // smaller arrays stay in memory
+};
+
+struct SpillStats {
+    size_t mRegions = 0;
+    size_t mMappedBytes = 0;
+    size_t mResidentBytes = 0;
+    uint64_t mFaults = 0;    // cold regions touched again
+    uint64_t mEvictions = 0; // regions dropped to meet the budget
+};
+
+class SpillStore;
+
+class SpillRegion {
+  public:
+    ~SpillRegion();
+    SpillRegion(const SpillRegion&) = delete;
+    SpillRegion& operator=(const SpillRegion&) = delete;
+
+    // Marks the region used; faults it back into the budget if dropped.
+    const void* acquire() {
+        mLastUse.store(mClock->load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+        if (!mResident.load(std::memory_order_acquire)) fault();
+        return mAddr;
+    }
+    size_t bytes() const { return mBytes; }
+
+  private:
+    friend class SpillStore;
+    SpillRegion(SpillStore& store, void* addr, size_t bytes);
+    void fault();
+
+    SpillStore& mStore;
+    const std::atomic<uint64_t>* mClock;
+    void* mAddr;
+    size_t mBytes;
+    std::atomic<uint64_t> mLastUse{0};
+    std::atomic<bool> mResident{true};
+};
+
+class SpillStore {
+  public:
+    static SpillStore& global();
+
+    // An empty mDir turns spilling off for arrays frozen afterwards;
+    // regions already mapped stay valid.
+    bool configure(const SpillOptions& opts, std::ostream* diag = nullptr);
+    bool enabled() const { return mEnabled.load(std::memory_order_relaxed); }
+    bool wants(size_t bytes) const {
+        return enabled() && bytes >= mOpts.mMinBytes && bytes > 0;
+    }
+    const SpillOptions& options() const { return mOpts; }
+
+    // Copies bytes into a new mapped region; nullptr on failure (the
+    // caller keeps its in-memory copy).
+    std::shared_ptr<SpillRegion> spill(const void* data, size_t bytes,
+                                       std::ostream* diag = nullptr);
+    // Drops regions, least recently used first, down to the budget.
+    void trim();
+    SpillStats stats() const;
+
+  private:
+    friend class SpillRegion;
+    void admit(SpillRegion& r);
+    void evictLocked(size_t budget, const SpillRegion* keep);
+    void remove(SpillRegion& r);
+
+    SpillOptions mOpts;
+    std::atomic<bool> mEnabled{false};
+    std::atomic<uint64_t> mClock{0};
+    mutable std::mutex mMutex;
+    std::vector<SpillRegion*> mRegions;
+    size_t mResident = 0;
+    uint64_t mFaults = 0;
+    uint64_t mEvictions = 0;
+};
+
+// Read-only array frozen from a vector: kept in memory, or spilled to a
+// mapped region when the global store wants it.
+template <typename T>
+class FrozenArray {
+  public:
+    FrozenArray() = default;
+    FrozenArray(std::vector<T>&& v) { *this = std::move(v); }
+    FrozenArray& operator=(std::vector<T>&& v) {
+        mRegion.reset();
+        mSize = v.size();
+        SpillStore& s = SpillStore::global();
+        if (s.wants(mSize * sizeof(T))) {
+            mRegion = s.spill(v.data(), mSize * sizeof(T));
+            if (mRegion) {
+                mVec = {};
+                return *this;
+            }
+        }
+        mVec = std::move(v);
+        return *this;
+    }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    const T* data() const {
+        if (mRegion) [[unlikely]]
+            return static_cast<const T*>(mRegion->acquire());
+        return mVec.data();
+    }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& back() const { return data()[mSize - 1]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + mSize; }
+    std::span<const T> span() const { return {data(), mSize}; }
+
+    bool spilled() const { return mRegion != nullptr; }
+    // Heap bytes; mapped bytes are accounted by the store.
+    size_t memoryBytes() const { return mVec.capacity() * sizeof(T); }
+
+  private:
+    std::vector<T> mVec;
+    std::shared_ptr<SpillRegion> mRegion; // shared by copies, read-only
+    size_t mSize = 0;
+};
+
+} // namespace hdl
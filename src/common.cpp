@@ -36,7 +36,7 @@ void error(std::ostream* diag, const std::string& msg, int indent) {
 }
 
 void update(elab::ParamSpec& out, const elab::ParamSpec& overrides) {
-    for (auto& [key, val] : out) {
+    for (auto& [key, val] : overrides) {
         if (auto it = out.find(key); it == out.end()) continue;
         out[key] = val;
     }
@@ -0,0 +1,204 @@
+// Micro-benchmarks for the netlist core. Usage: hdl_bench [uf|decode] ...
+//   uf [bits] [unions] [maxThreads]
+//     Sequential vs concurrent union-find scaling (1..maxThreads threads).
+//   decode [pins] [reps]
+//     Packed connection bits: size vs raw and decode throughput.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hdl/net/connectivity.hpp"
+#include "hdl/net/packed_bits.hpp"
+
+using namespace hdl;
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0)
+      .count();
+}
+
+// Smallest member of each bit's set; equal vectors mean equal partitions.
+static std::vector<net::BitId> canonicalLabels(net::Connectivity& conn) {
+    std::vector<net::BitId> minOf(conn.size(), UINT32_MAX);
+    for (net::BitId i = 0; i < conn.size(); ++i) {
+        auto r = conn.netId(i);
+        minOf[r] = std::min(minOf[r], i);
+    }
+    std::vector<net::BitId> label(conn.size());
+    for (net::BitId i = 0; i < conn.size(); ++i)
+        label[i] = minOf[conn.netId(i)];
+    return label;
+}
+
+static int benchUnionFind(uint32_t bits, uint32_t unions,
+                          unsigned maxThreads) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<uint32_t> pick(0, bits - 1);
+    std::vector<std::pair<net::BitId, net::BitId>> pairs(unions);
+    for (auto& p : pairs)
+        p = {pick(rng), pick(rng)};
+
+    std::cout << "union-find: bits=" << bits << " unions=" << unions << "\n";
+
+    net::Connectivity seq;
+    seq.allocRange(bits);
+    auto t0 = Clock::now();
+    for (auto& [a, b] : pairs)
+        seq.alias(a, b);
+    double seqMs = msSince(t0);
+    auto ref = canonicalLabels(seq);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  sequential          " << std::setw(10) << seqMs
+              << " ms\n";
+    std::cout << "  threads    time(ms)   speedup   Munions/s  partition\n";
+
+    for (unsigned t = 1; t <= maxThreads; t *= 2) {
+        net::Connectivity conc(net::UnionFindMode::Concurrent);
+        conc.allocRange(bits);
+        std::vector<std::thread> pool;
+        auto t1 = Clock::now();
+        for (unsigned k = 0; k < t; ++k) {
+            pool.emplace_back([&, k] {
+                size_t lo = pairs.size() * k / t;
+                size_t hi = pairs.size() * (k + 1) / t;
+                for (size_t i = lo; i < hi; ++i)
+                    conc.alias(pairs[i].first, pairs[i].second);
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+        double ms = msSince(t1);
+        bool same = canonicalLabels(conc) == ref;
+        std::cout << "  " << std::setw(7) << t << std::setw(12) << ms
+                  << std::setw(10) << seqMs / ms << std::setw(12)
+                  << unions / ms / 1000.0 << "  "
+                  << (same ? "match" : "MISMATCH") << "\n";
+        if (!same) return 1;
+    }
+    return 0;
+}
+
+// Pin bits shaped like a flat gate-level top: scalar cell pins near a
+// drifting cursor, some bus bindings (consecutive ids), global clock/reset
+// nets, ties and open pins.
+static std::vector<net::BitId> syntheticPins(size_t pins) {
+    std::mt19937 rng(7);
+    std::vector<net::BitId> v;
+    v.reserve(pins);
+    net::BitId cursor = 1000;
+    while (v.size() < pins) {
+        uint32_t r = rng() % 100;
+        if (r < 10) { // bus of a macro
+            uint32_t w = 8u << (rng() % 3);
+            net::BitId b = cursor - rng() % 1024;
+            for (uint32_t k = 0; k < w; ++k)
+                v.push_back(b + k);
+        } else if (r < 90) { // scalar pins of a cell
+            for (uint32_t k = 0, n = 2 + rng() % 3; k < n; ++k)
+                v.push_back(cursor - rng() % 64);
+            cursor += 1 + rng() % 4;
+        } else if (r < 96) {
+            v.push_back(3 + rng() % 2); // clock / reset
+        } else if (r < 98) {
+            v.push_back(7); // tie
+        } else {
+            v.push_back(UINT32_MAX); // open
+        }
+    }
+    v.resize(pins);
+    return v;
+}
+
+static int benchDecode(size_t pins, unsigned reps) {
+    auto raw = syntheticPins(pins);
+    auto t0 = Clock::now();
+    net::PackedBitArray packed(raw);
+    double encMs = msSince(t0);
+
+    size_t modes[5] = {};
+    for (size_t b = 0; b < packed.blockCount(); ++b)
+        ++modes[static_cast<int>(packed.mode(b))];
+    size_t rawBytes = raw.size() * sizeof(net::BitId);
+    std::cout << "pins=" << pins << " raw=" << rawBytes
+              << " packed=" << packed.memoryBytes() << " ratio="
+              << std::setprecision(3)
+              << double(rawBytes) / packed.memoryBytes()
+              << " encode=" << encMs << "ms\n"
+              << "blocks stride=" << modes[0] << " for8=" << modes[1]
+              << " for16=" << modes[2] << " delta8=" << modes[3]
+              << " raw=" << modes[4] << "\n";
+
+    uint64_t ref = 0;
+    for (net::BitId b : raw)
+        ref += b;
+    std::vector<net::BitId> buf(net::PackedBitArray::kBlock);
+    auto run = [&](const char* name, auto&& body) {
+        uint64_t sum = 0;
+        auto t1 = Clock::now();
+        for (unsigned r = 0; r < reps; ++r)
+            sum += body();
+        double ms = msSince(t1);
+        bool ok = sum == ref * reps;
+        std::cout << "  " << std::left << std::setw(10) << name << std::right
+                  << std::setw(10) << ms << "ms" << std::setw(10)
+                  << double(pins) * reps / ms / 1000.0 << " Mpins/s  "
+                  << (ok ? "match" : "MISMATCH") << "\n";
+        return ok;
+    };
+    bool ok = true;
+    ok &= run("raw", [&] {
+        uint64_t s = 0;
+        for (net::BitId b : raw)
+            s += b;
+        return s;
+    });
+    ok &= run("blocks", [&] {
+        uint64_t s = 0;
+        for (size_t b = 0; b < packed.blockCount(); ++b) {
+            uint32_t n = packed.decodeBlock(b, buf.data());
+            for (uint32_t k = 0; k < n; ++k)
+                s += buf[k];
+        }
+        return s;
+    });
+    ok &= run("iterator", [&] {
+        uint64_t s = 0;
+        for (net::BitId b : packed)
+            s += b;
+        return s;
+    });
+    ok &= run("index", [&] {
+        uint64_t s = 0;
+        for (size_t i = 0; i < packed.size(); ++i)
+            s += packed[i];
+        return s;
+    });
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "uf";
+    auto arg = [&](int i, uint64_t def) -> uint64_t {
+        return argc > i ? std::strtoull(argv[i], nullptr, 10) : def;
+    };
+    if (mode == "uf") {
+        return benchUnionFind(static_cast<uint32_t>(arg(2, 1u << 22)),
+                              static_cast<uint32_t>(arg(3, 1u << 22)),
+                              static_cast<unsigned>(arg(4, 64)));
+    }
+    if (mode == "decode") {
+        return benchDecode(arg(2, 1u << 24),
+                           static_cast<unsigned>(arg(3, 8)));
+    }
+    std::cerr << "unknown benchmark: " << mode << "\n";
+    return 1;
+}
@@ -160,11 +160,11 @@ int main() {
 
     // Sample PinKey: first child of Top, port p_in
     std::cout << "\n=== PinKey sample ===\n";
-    hier::ScopeId s;
-    if (!modTop.mInstances.empty()) s.mPath.push_back(0);
+    hier::ScopeTable scopes(modTop);
+    hier::ScopeHandle s = scopes.child(hier::kRootScope, 0);
     hier::PinKey pk;
-    if (hier::makePinKey(modTop, s, p_in, pk, &std::cerr)) {
-        std::cout << "PinKey scope=" << pk.mScope.toString()
+    if (hier::makePinKey(scopes, s, p_in, pk, &std::cerr)) {
+        std::cout << "PinKey scope=" << scopes.toString(pk.mScope)
                   << " portIndex=" << pk.mPortIndex << "\n";
     }
 
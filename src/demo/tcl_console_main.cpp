@@ -80,7 +80,7 @@ int main() {
     ModuleSpec& specA = getOrCreateSpec(declLib[A], {}, specLib);
     ModuleSpec& specTop =
       getOrCreateSpec(declLib[Top], {{DO_EXTRA, 1}, {REPL, 2}}, specLib);
-    linkInstances(specTop, declLib, specLib, &std::cerr);
+    linkHierarchy(specTop, declLib, specLib, &std::cerr);
 
     // Start the Tcl console
     hdl::tcl::Console console(specLib, declLib, std::cerr);
@@ -0,0 +1,115 @@
+#include "hdl/elab/cells.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace hdl::elab {
+
+int CellType::findPin(IdString n) const {
+    for (uint32_t p = 0; p < mPins.size(); ++p)
+        if (mPins[p].mName == n) return static_cast<int>(p);
+    return -1;
+}
+
+static bool parseDir(const std::string& s, PortDirection& out) {
+    if (s == "in" || s == "input") out = PortDirection::In;
+    else if (s == "out" || s == "output") out = PortDirection::Out;
+    else if (s == "inout") out = PortDirection::InOut;
+    else return false;
+    return true;
+}
+
+bool CellLibrary::load(std::istream& in, std::ostream* diag) {
+    CellType cur;
+    bool open = false;
+    std::string line;
+    uint32_t lineNo = 0;
+    auto fail = [&](const std::string& msg) {
+        error(diag, "cells:" + std::to_string(lineNo) + ": " + msg);
+        return false;
+    };
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (auto hash = line.find('#'); hash != std::string::npos)
+            line.resize(hash);
+        std::istringstream ls(line);
+        std::string kw, a, b, extra;
+        if (!(ls >> kw)) continue;
+        ls >> a >> b >> extra;
+        if (!extra.empty()) return fail("trailing tokens");
+
+        if (kw == "cell") {
+            if (open) return fail("missing 'end' before cell " + a);
+            if (a.empty() || !b.empty()) return fail("usage: cell <name>");
+            cur = CellType{};
+            cur.mName = IdString(a);
+            open = true;
+        } else if (!open) {
+            return fail("'" + kw + "' outside a cell");
+        } else if (kw == "pin") {
+            CellPin p{IdString(a)};
+            if (a.empty() || !parseDir(b, p.mDir))
+                return fail("usage: pin <name> in|out|inout");
+            if (cur.findPin(p.mName) >= 0) return fail("duplicate pin " + a);
+            cur.mPins.push_back(p);
+        } else if (kw == "arc") {
+            int from = cur.findPin(IdString(a, IdString::NoIntern));
+            int to = cur.findPin(IdString(b, IdString::NoIntern));
+            if (from < 0 || to < 0) return fail("arc on unknown pin");
+            cur.mArcs.push_back(CellArc{static_cast<uint32_t>(from),
+                                        static_cast<uint32_t>(to)});
+        } else if (kw == "end") {
+            auto [it, fresh] = mIndex.emplace(cur.mName, size());
+            if (fresh) {
+                mTypes.push_back(std::move(cur));
+            } else {
+                warn(diag, "cell " + cur.mName.str() + " redefined");
+                mTypes[it->second] = std::move(cur);
+            }
+            open = false;
+        } else {
+            return fail("unknown statement '" + kw + "'");
+        }
+    }
+    if (open) return fail("missing 'end' for cell " + cur.mName.str());
+    return true;
+}
+
+bool CellLibrary::loadFile(const std::string& path, std::ostream* diag) {
+    std::ifstream in(path);
+    if (!in) {
+        error(diag, "cannot open " + path);
+        return false;
+    }
+    return load(in, diag);
+}
+
+int CellLibrary::findIndex(IdString name) const {
+    auto it = mIndex.find(name);
+    return it == mIndex.end() ? -1 : static_cast<int>(it->second);
+}
+
+uint32_t PrimTable::add(IdString name, uint32_t typeId) {
+    if (mPinOffsets.empty()) mPinOffsets.push_back(0);
+    uint32_t i = size();
+    mNames.push_back(name);
+    mTypes.push_back(typeId);
+    mPinBits.resize(mPinBits.size() + mLib->type(typeId).mPins.size(),
+                    kOpenPin);
+    mPinOffsets.push_back(static_cast<uint32_t>(mPinBits.size()));
+    return i;
+}
+
+void PrimTable::clear() {
+    const CellLibrary* lib = mLib;
+    *this = PrimTable{};
+    mLib = lib;
+}
+
+size_t PrimTable::memoryBytes() const {
+    return mNames.capacity() * sizeof(IdString) +
+           (mTypes.capacity() + mPinOffsets.capacity()) * sizeof(uint32_t) +
+           mPinBits.capacity() * sizeof(net::BitId);
+}
+
+} // namespace hdl::elab
@@ -2,6 +2,8 @@
 #include <cassert>
 #include <iostream>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 #include "hdl/ast/decl.hpp"
@@ -86,28 +88,24 @@ static bool isConnectable(const BitAtom& a) {
     return a.mKind == BitAtomKind::PortBit || a.mKind == BitAtomKind::WireBit;
 }
 
-static net::BitId toBitId(const ModuleSpec& spec, const BitAtom& a) {
-    if (a.mKind == BitAtomKind::PortBit) {
-        int idx = spec.findPortIndex(a.mOwnerIndex);
-        if (idx < 0) return UINT32_MAX;
-        return spec.mBitMap.portBit(static_cast<uint32_t>(idx), a.mBitIndex);
-    }
-    if (a.mKind == BitAtomKind::WireBit) {
-        int idx = spec.findWireIndex(a.mOwnerIndex);
-        if (idx < 0) return UINT32_MAX;
-        return spec.mBitMap.wireBit(static_cast<uint32_t>(idx), a.mBitIndex);
-    }
-    return UINT32_MAX;
-}
-
 void wireAssigns(ModuleSpec& spec) {
     if (!spec.mDecl) return;
     FlattenContext fc(spec, &std::cerr);
+    std::erase_if(spec.mWidthMismatches,
+                  [](const WidthMismatch& w) { return !w.mInstance.valid(); });
+    spec.mConstDrivers.clear();
 
-    for (const auto& asg : spec.mDecl->mAssigns) {
+    for (uint32_t ai = 0; ai < spec.mDecl->mAssigns.size(); ++ai) {
+        const auto& asg = spec.mDecl->mAssigns[ai];
         auto L = fc.flattenExpr(asg.mLhs);
         auto R = fc.flattenExpr(asg.mRhs);
         if (L.size() != R.size()) {
+            spec.mWidthMismatches.push_back(
+              WidthMismatch{IdString(),
+                            IdString(),
+                            ai,
+                            static_cast<uint32_t>(L.size()),
+                            static_cast<uint32_t>(R.size())});
             std::cerr << "ERROR: assign width mismatch in module "
                       << spec.mName.str()
                       << " (lhs=" << ast::bvExprToString(asg.mLhs)
@@ -122,13 +120,16 @@ void wireAssigns(ModuleSpec& spec) {
                           << i << "\n";
                 continue;
             }
-            if (!isConnectable(r)) {
-                // Ignore constants in RHS for demo.
+            // Constant RHS bits are recorded as directed sources; aliasing
+            // them into the tie nets would merge every tied-off wire.
+            net::BitId bl = spec.atomBit(l);
+            if (r.mKind == BitAtomKind::Const0 ||
+                r.mKind == BitAtomKind::Const1) {
+                spec.mConstDrivers.push_back(
+                  ConstDriver{bl, r.mKind == BitAtomKind::Const1});
                 continue;
             }
-            net::BitId bl = toBitId(spec, l);
-            net::BitId br = toBitId(spec, r);
-            spec.mBitMap.alias(bl, br);
+            spec.mBitMap.alias(bl, spec.atomBit(r));
         }
     }
 }
@@ -140,11 +141,14 @@ ModuleSpec& getOrCreateSpec(const ast::ModuleDecl& decl,
     update(/* out */ env, overrides);
     IdString key(makeModuleKey(decl.mName.str(), env));
     auto it = specLib.find(key);
-    if (it != specLib.end()) return it->second;
+    if (it != specLib.end())
+        return it->second.mAliasOf ? *it->second.mAliasOf : it->second;
     ModuleSpec ms = elaborateModule(decl, env);
     specLib.emplace(key, std::move(ms)); // ms is invalid now
-    wireAssigns(specLib[key]);
-    return specLib[key];
+    ModuleSpec& spec = specLib[key];
+    wireAssigns(spec);
+    spec.mBitMap.freeze();
+    return spec;
 }
 
 void expandGenBlk(const ModuleSpec& spec, const ast::GenBody& block,
@@ -235,9 +239,52 @@ static void expandGenerates(const ModuleSpec& spec,
     }
 }
 
+// Binds one primitive instance; pins are scalar.
+static void linkPrim(ModuleSpec& spec, const ast::InstanceDecl& idecl,
+                     uint32_t typeId, std::ostream* diag) {
+    const CellType& ct = spec.mPrims.mLib->type(typeId);
+    uint32_t i = spec.mPrims.add(idecl.mName, typeId);
+    FlattenContext fc(spec, diag);
+    for (const auto& c : idecl.mConns) {
+        int pin = ct.findPin(c.mFormal);
+        if (pin < 0) {
+            error(diag,
+                  "unknown pin '" + c.mFormal.str() + "' on cell instance " +
+                    idecl.mName.str() + " in module " + spec.mName.str());
+            continue;
+        }
+        BitVector actual = fc.flattenExpr(c.mActual);
+        if (actual.size() != 1) {
+            spec.mWidthMismatches.push_back(WidthMismatch{
+              idecl.mName, c.mFormal, 0, 1,
+              static_cast<uint32_t>(actual.size())});
+            error(diag,
+                  "width mismatch binding " + idecl.mName.str() + "." +
+                    c.mFormal.str() + " Wf=1 Wa=" +
+                    std::to_string(actual.size()));
+            continue;
+        }
+        spec.mPrims.pins(i)[pin] = spec.atomBit(actual[0]);
+    }
+}
+
 void linkInstances(ModuleSpec& spec, const ModuleDeclLib& declLib,
-                   ModuleSpecLib& spceLib, std::ostream* diag) {
+                   ModuleSpecLib& spceLib, std::ostream* diag,
+                   const CellLibrary* cells) {
+    // Drop this spec's reverse edges from the previous link.
+    for (const auto& inst : spec.mInstances) {
+        if (!inst.mCallee) continue;
+        std::erase_if(inst.mCallee->mUsers,
+                      [&](const SpecUse& u) { return u.mParent == &spec; });
+    }
     spec.mInstances.clear();
+    spec.mInstanceIndex.clear();
+    spec.mPrims.clear();
+    spec.mPrims.mLib = cells;
+    spec.mInstTable.clear();
+    spec.mFanout.clear();
+    std::erase_if(spec.mWidthMismatches,
+                  [](const WidthMismatch& w) { return w.mInstance.valid(); });
     if (!spec.mDecl) return;
 
     // Expand generate constructs and gather all instances to link.
@@ -246,6 +293,11 @@ void linkInstances(ModuleSpec& spec, const ModuleDeclLib& declLib,
 
     // Bind each instance
     for (const auto& idecl : flatInsts) {
+        if (int cell = cells ? cells->findIndex(idecl.mTargetModule) : -1;
+            cell >= 0) {
+            linkPrim(spec, idecl, static_cast<uint32_t>(cell), diag);
+            continue;
+        }
         auto it = declLib.find(idecl.mTargetModule);
         if (it == declLib.end()) {
             error(diag,
@@ -290,6 +342,12 @@ void linkInstances(ModuleSpec& spec, const ModuleDeclLib& declLib,
             uint32_t Wf = callee.mPorts[formalIdx].width();
             BitVector actual = fc.flattenExpr(c.mActual);
             if (actual.size() != Wf) {
+                spec.mWidthMismatches.push_back(
+                  WidthMismatch{idecl.mName,
+                                c.mFormal,
+                                0,
+                                Wf,
+                                static_cast<uint32_t>(actual.size())});
                 error(diag,
                       "width mismatch binding " + idecl.mName.str() + "." +
                         c.mFormal.str() + " Wf=" + std::to_string(Wf) +
@@ -301,20 +359,104 @@ void linkInstances(ModuleSpec& spec, const ModuleDeclLib& declLib,
               ConnSpec{static_cast<uint32_t>(formalIdx), std::move(actual)});
         }
 
+        if (!spec.mInstanceIndex
+               .emplace(inst.mName,
+                        static_cast<uint32_t>(spec.mInstances.size()))
+               .second) {
+            warn(diag,
+                 "duplicate instance name " + inst.mName.str() +
+                   " in module " + spec.mName.str());
+        }
+        callee.mUsers.push_back(
+          SpecUse{&spec, static_cast<uint32_t>(spec.mInstances.size())});
         spec.mInstances.push_back(std::move(inst));
     }
+    spec.mInstTable.build(spec);
+    spec.mFanout.build(spec);
+}
+
+void linkHierarchy(ModuleSpec& top, const ModuleDeclLib& declLib,
+                   ModuleSpecLib& specLib, std::ostream* diag,
+                   const CellLibrary* cells) {
+    // InstanceSpec::mCallee is const; map back to the owning lib entries.
+    std::unordered_map<const ModuleSpec*, ModuleSpec*> owner;
+    auto refreshOwners = [&] {
+        for (auto& [key, s] : specLib)
+            owner.emplace(&s, &s);
+    };
+    std::unordered_set<const ModuleSpec*> seen{&top};
+    std::vector<ModuleSpec*> work{&top};
+    while (!work.empty()) {
+        ModuleSpec* spec = work.back();
+        work.pop_back();
+        linkInstances(*spec, declLib, specLib, diag, cells);
+        for (const auto& inst : spec->mInstances) {
+            if (!inst.mCallee || !seen.insert(inst.mCallee).second) continue;
+            if (!owner.count(inst.mCallee)) refreshOwners();
+            work.push_back(owner.at(inst.mCallee));
+        }
+    }
 }
 
 namespace hier {
 
+struct DumpState {
+    const DumpOptions& mOpts;
+    // Scope where each spec was first expanded (dedup mode only). Elided
+    // bodies are not recorded, so a back-reference always points at a
+    // printed subtree.
+    std::unordered_map<const ModuleSpec*, std::string> mFirst;
+};
+
 static void dumpRecur(const ModuleSpec& spec, std::ostream& os,
-                      const ScopeId& scope, int indent) {
+                      ScopeId& scope, int indent, DumpState& st) {
+    std::string here = scope.toString();
     os << Indent(indent) << "Module '" << spec.mName.str()
-       << "' scope=" << scope.toString() << "\n";
+       << "' scope=" << here;
+    if (st.mOpts.mDedup &&
+        (!spec.mInstances.empty() || !spec.mPrims.empty())) {
+        auto it = st.mFirst.find(&spec);
+        if (it != st.mFirst.end()) {
+            os << " (same as scope=" << it->second << ")\n";
+            return;
+        }
+        if (scope.mPath.size() < st.mOpts.mMaxDepth)
+            st.mFirst.emplace(&spec, here);
+    }
+    os << "\n";
+
+    const PrimTable& prims = spec.mPrims;
+    if (!prims.empty()) {
+        os << Indent(indent + 2) << "Cells (" << prims.size() << "):";
+        if (scope.mPath.size() >= st.mOpts.mMaxDepth) {
+            os << " <elided below depth " << st.mOpts.mMaxDepth << ">\n";
+        } else {
+            os << "\n";
+            for (uint32_t i = 0; i < prims.size(); ++i) {
+                const CellType& ct = prims.type(i);
+                os << Indent(indent + 4) << "[" << i << "] "
+                   << prims.mNames[i].str() << " : " << ct.mName.str() << "\n";
+                auto pins = prims.pins(i);
+                for (uint32_t k = 0; k < pins.size(); ++k) {
+                    os << Indent(indent + 6) << ct.mPins[k].mName.str() << " ("
+                       << to_string(ct.mPins[k].mDir) << ") <= "
+                       << (pins[k] == PrimTable::kOpenPin
+                             ? std::string("<open>")
+                             : spec.renderBit(pins[k]))
+                       << "\n";
+                }
+            }
+        }
+    }
 
     if (!spec.mInstances.empty()) {
         os << Indent(indent + 2) << "Instances (" << spec.mInstances.size()
-           << "):\n";
+           << "):";
+        if (scope.mPath.size() >= st.mOpts.mMaxDepth) {
+            os << " <elided below depth " << st.mOpts.mMaxDepth << ">\n";
+            return;
+        }
+        os << "\n";
     }
 
     for (size_t idx = 0; idx < spec.mInstances.size(); ++idx) {
@@ -351,37 +493,27 @@ static void dumpRecur(const ModuleSpec& spec, std::ostream& os,
 
         // Recurse into callee spec
         if (inst.mCallee) {
-            ScopeId childScope = scope;
-            childScope.mPath.push_back(static_cast<uint32_t>(idx));
-            dumpRecur(*inst.mCallee, os, childScope, indent + 4);
+            scope.mPath.push_back(static_cast<uint32_t>(idx));
+            dumpRecur(*inst.mCallee, os, scope, indent + 4, st);
+            scope.mPath.pop_back();
         }
     }
 }
 
-void dumpInstanceTree(const ModuleSpec& top, std::ostream& os) {
+void dumpInstanceTree(const ModuleSpec& top, std::ostream& os,
+                      const DumpOptions& opts) {
     ScopeId root;
-    dumpRecur(top, os, root, 0);
+    DumpState st{opts, {}};
+    dumpRecur(top, os, root, 0, st);
 }
 
-bool makePinKey(const ModuleSpec& top, const ScopeId& scope, IdString portName,
+bool makePinKey(const ScopeTable& scopes, ScopeHandle scope, IdString portName,
                 PinKey& out, std::ostream* diag) {
-    const ModuleSpec* cur = &top;
-    for (size_t depth = 0; depth < scope.mPath.size(); ++depth) {
-        uint32_t idx = scope.mPath[depth];
-        if (idx >= cur->mInstances.size()) {
-            error(diag,
-                  "scope path index " + std::to_string(idx) +
-                    " out of range at depth " + std::to_string(depth));
-            return false;
-        }
-        const auto& inst = cur->mInstances[idx];
-        if (!inst.mCallee) {
-            error(diag, "null callee at depth " + std::to_string(depth));
-            return false;
-        }
-        cur = inst.mCallee;
+    if (scope == kInvalidScope || scope >= scopes.size()) {
+        error(diag, "invalid scope handle");
+        return false;
     }
-    int pIdx = cur->findPortIndex(portName);
+    int pIdx = scopes.spec(scope).findPortIndex(portName);
     if (pIdx < 0) {
         error(diag, "no such port in module");
         return false;
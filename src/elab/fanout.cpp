@@ -0,0 +1,104 @@
+#include "hdl/elab/fanout.hpp"
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab {
+
+namespace {
+
+struct Pending {
+    net::NetId mNet;
+    NetEndpoint mEp;
+};
+
+void toCsr(std::vector<Pending>& items, net::NetId nets,
+           FrozenArray<uint32_t>& offsetsOut,
+           FrozenArray<NetEndpoint>& endpointsOut) {
+    std::vector<uint32_t> offsets(static_cast<size_t>(nets) + 1, 0);
+    for (const auto& p : items)
+        ++offsets[p.mNet + 1];
+    for (size_t n = 1; n < offsets.size(); ++n)
+        offsets[n] += offsets[n - 1];
+    std::vector<NetEndpoint> out(items.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& p : items)
+        out[cursor[p.mNet]++] = p.mEp;
+    offsetsOut = std::move(offsets);
+    endpointsOut = std::move(out);
+}
+
+} // namespace
+
+void FanoutIndex::build(const ModuleSpec& spec) {
+    const auto& bm = spec.mBitMap;
+    std::vector<Pending> drv, ld;
+    auto add = [&](PortDirection dir, bool outside, net::NetId n,
+                   const NetEndpoint& ep) {
+        // An own input is driven from outside; a child input is a load.
+        bool drives = outside ? dir != PortDirection::Out
+                              : dir != PortDirection::In;
+        bool reads = outside ? dir != PortDirection::In
+                             : dir != PortDirection::Out;
+        if (drives) drv.push_back(Pending{n, ep});
+        if (reads) ld.push_back(Pending{n, ep});
+    };
+
+    for (uint32_t p = 0; p < spec.mPorts.size(); ++p) {
+        for (uint32_t k = 0; k < spec.mPorts[p].width(); ++k) {
+            add(spec.mPorts[p].mDir,
+                true,
+                bm.netOf(bm.portBit(p, k)),
+                NetEndpoint{EndpointKind::Port, p, p, k});
+        }
+    }
+    const InstanceTable& it = spec.mInstTable;
+    std::vector<net::BitId> scratch;
+    for (uint32_t i = 0; i < it.size(); ++i) {
+        const ModuleSpec* callee = it.callee(i);
+        if (!callee) continue;
+        auto bound = it.bits(i).decode(scratch);
+        net::BitId cb = 0;
+        for (uint32_t p = 0; p < callee->mPorts.size(); ++p) {
+            PortDirection dir = callee->mPorts[p].mDir;
+            for (uint32_t k = 0; k < callee->mPorts[p].width(); ++k, ++cb) {
+                if (bound[cb] == InstanceTable::kOpenPin) continue;
+                add(dir,
+                    false,
+                    bm.netOf(bound[cb]),
+                    NetEndpoint{EndpointKind::ChildPin, i, p, k});
+            }
+        }
+    }
+    const PrimTable& prims = spec.mPrims;
+    for (uint32_t i = 0; i < prims.size(); ++i) {
+        const CellType& ct = prims.type(i);
+        auto pins = prims.pins(i);
+        for (uint32_t p = 0; p < pins.size(); ++p) {
+            if (pins[p] == PrimTable::kOpenPin) continue;
+            add(ct.mPins[p].mDir,
+                false,
+                bm.netOf(pins[p]),
+                NetEndpoint{EndpointKind::Cell, i, p, 0});
+        }
+    }
+    // Constant bindings use the tie bits, which drive their nets; constant
+    // assigns drive the assigned bit's own net.
+    if (bm.mConn.size() >= 2) {
+        for (uint32_t v = 0; v < 2; ++v)
+            drv.push_back(Pending{bm.netOf(bm.tieBit(v)),
+                                  NetEndpoint{EndpointKind::Const, v}});
+    }
+    for (const ConstDriver& d : spec.mConstDrivers)
+        drv.push_back(Pending{bm.netOf(d.mBit),
+                              NetEndpoint{EndpointKind::Const, d.mOne}});
+
+    toCsr(drv, bm.netCount(), mDriverOffsets, mDrivers);
+    toCsr(ld, bm.netCount(), mLoadOffsets, mLoads);
+}
+
+size_t FanoutIndex::memoryBytes() const {
+    return mDriverOffsets.memoryBytes() + mLoadOffsets.memoryBytes() +
+           mDrivers.memoryBytes() + mLoads.memoryBytes();
+}
+
+} // namespace hdl::elab
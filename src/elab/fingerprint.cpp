@@ -0,0 +1,232 @@
+#include "hdl/elab/fingerprint.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "hdl/common.hpp"
+#include "hdl/elab/elaborate.hpp"
+
+namespace hdl::elab {
+
+namespace {
+
+struct Hasher {
+    uint64_t mH = 0x9e3779b97f4a7c15ull;
+    void add(uint64_t v) {
+        // splitmix64 finalizer over the running state
+        uint64_t z = mH ^ (v + 0x9e3779b97f4a7c15ull + (mH << 6) + (mH >> 2));
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        mH = z ^ (z >> 31);
+    }
+    void add(IdString s) { add(IdString::Hash{}(s)); }
+};
+
+bool sameNet(const NetSpec& a, const NetSpec& b) {
+    return a.mMsb == b.mMsb && a.mLsb == b.mLsb;
+}
+
+bool sameAtoms(const BitVector& a, const BitVector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const BitAtom& x, const BitAtom& y) {
+                          return x.mKind == y.mKind &&
+                                 x.mOwnerIndex == y.mOwnerIndex &&
+                                 x.mBitIndex == y.mBitIndex;
+                      });
+}
+
+const ModuleSpec* canonical(const ModuleSpec* s) {
+    while (s && s->mAliasOf)
+        s = s->mAliasOf;
+    return s;
+}
+
+} // namespace
+
+uint64_t structuralFingerprint(const ModuleSpec& spec,
+                               const SpecFingerprints& fps) {
+    Hasher h;
+    h.add(spec.mName);
+    h.add(spec.mPorts.size());
+    for (const auto& p : spec.mPorts) {
+        h.add(p.mName);
+        h.add(static_cast<uint64_t>(p.mDir));
+        h.add(static_cast<uint64_t>(p.mNet.mMsb));
+        h.add(static_cast<uint64_t>(p.mNet.mLsb));
+    }
+    h.add(spec.mWires.size());
+    for (const auto& w : spec.mWires) {
+        h.add(w.mName);
+        h.add(static_cast<uint64_t>(w.mNet.mMsb));
+        h.add(static_cast<uint64_t>(w.mNet.mLsb));
+    }
+    // Frozen net ids are numbered by smallest member bit, so the label
+    // sequence is a canonical form of the partition.
+    const auto& conn = spec.mBitMap.mConn;
+    h.add(conn.size());
+    for (net::BitId b = 0; b < conn.size(); ++b)
+        h.add(spec.mBitMap.netOf(b));
+    h.add(spec.mConstDrivers.size());
+    for (const auto& d : spec.mConstDrivers)
+        h.add(uint64_t(d.mBit) << 1 | d.mOne);
+    h.add(spec.mInstances.size());
+    for (const auto& inst : spec.mInstances) {
+        h.add(inst.mName);
+        auto it = fps.find(canonical(inst.mCallee));
+        h.add(it == fps.end() ? 0 : it->second);
+        for (const auto& c : inst.mConns) {
+            h.add(c.mFormalIndex);
+            for (const auto& a : c.mActual) {
+                h.add(static_cast<uint64_t>(a.mKind));
+                h.add(a.mOwnerIndex);
+                h.add(a.mBitIndex);
+            }
+        }
+    }
+    const PrimTable& prims = spec.mPrims;
+    h.add(prims.size());
+    for (uint32_t i = 0; i < prims.size(); ++i) {
+        h.add(prims.mNames[i]);
+        h.add(prims.type(i).mName);
+        for (net::BitId b : prims.pins(i))
+            h.add(b);
+    }
+    return h.mH;
+}
+
+bool structurallyEqual(const ModuleSpec& a, const ModuleSpec& b) {
+    if (a.mName != b.mName || a.mPorts.size() != b.mPorts.size() ||
+        a.mWires.size() != b.mWires.size() ||
+        a.mInstances.size() != b.mInstances.size())
+        return false;
+    for (size_t i = 0; i < a.mPorts.size(); ++i) {
+        const auto &x = a.mPorts[i], &y = b.mPorts[i];
+        if (x.mName != y.mName || x.mDir != y.mDir || !sameNet(x.mNet, y.mNet))
+            return false;
+    }
+    for (size_t i = 0; i < a.mWires.size(); ++i) {
+        const auto &x = a.mWires[i], &y = b.mWires[i];
+        if (x.mName != y.mName || !sameNet(x.mNet, y.mNet)) return false;
+    }
+    const auto &ca = a.mBitMap.mConn, &cb = b.mBitMap.mConn;
+    if (ca.size() != cb.size()) return false;
+    for (net::BitId i = 0; i < ca.size(); ++i)
+        if (a.mBitMap.netOf(i) != b.mBitMap.netOf(i)) return false;
+    if (a.mConstDrivers != b.mConstDrivers) return false;
+    for (size_t i = 0; i < a.mInstances.size(); ++i) {
+        const auto &x = a.mInstances[i], &y = b.mInstances[i];
+        if (x.mName != y.mName ||
+            canonical(x.mCallee) != canonical(y.mCallee) ||
+            x.mConns.size() != y.mConns.size())
+            return false;
+        for (size_t k = 0; k < x.mConns.size(); ++k) {
+            if (x.mConns[k].mFormalIndex != y.mConns[k].mFormalIndex ||
+                !sameAtoms(x.mConns[k].mActual, y.mConns[k].mActual))
+                return false;
+        }
+    }
+    const PrimTable &pa = a.mPrims, &pb = b.mPrims;
+    if (pa.mLib != pb.mLib || pa.mNames != pb.mNames ||
+        pa.mTypes != pb.mTypes || pa.mPinBits != pb.mPinBits)
+        return false;
+    return true;
+}
+
+SpecMergeStats mergeEquivalentSpecs(ModuleSpecLib& lib, std::ostream* diag) {
+    SpecMergeStats st;
+    // Key order makes the surviving entry deterministic.
+    std::vector<std::pair<std::string, ModuleSpec*>> roots;
+    for (auto& [key, s] : lib) {
+        if (s.mAliasOf) continue;
+        roots.emplace_back(key.str(), &s);
+        ++st.mSpecs;
+        st.mBytesBefore += s.memoryBytes();
+    }
+    std::sort(roots.begin(), roots.end());
+
+    std::unordered_map<const ModuleSpec*, ModuleSpec*> owner;
+    for (auto& [key, s] : roots)
+        owner.emplace(s, s);
+
+    // Post-order over callees: children are merged before their parents.
+    std::vector<ModuleSpec*> order;
+    std::unordered_map<const ModuleSpec*, uint8_t> state; // 1 open, 2 done
+    for (auto& [key, root] : roots) {
+        if (state[root]) continue;
+        std::vector<std::pair<ModuleSpec*, size_t>> stack{{root, 0}};
+        state[root] = 1;
+        while (!stack.empty()) {
+            auto& [s, next] = stack.back();
+            if (next < s->mInstances.size()) {
+                const ModuleSpec* c = canonical(s->mInstances[next++].mCallee);
+                auto it = owner.find(c);
+                if (it == owner.end() || state[c]) continue;
+                state[c] = 1;
+                stack.emplace_back(it->second, 0);
+                continue;
+            }
+            state[s] = 2;
+            order.push_back(s);
+            stack.pop_back();
+        }
+    }
+
+    SpecFingerprints fps;
+    std::unordered_map<uint64_t, std::vector<ModuleSpec*>> buckets;
+    for (ModuleSpec* s : order) {
+        for (auto& inst : s->mInstances)
+            inst.mCallee = canonical(inst.mCallee);
+        uint64_t fp = structuralFingerprint(*s, fps);
+        fps.emplace(s, fp);
+        auto& bucket = buckets[fp];
+        ModuleSpec* keep = nullptr;
+        for (ModuleSpec* c : bucket) {
+            if (structurallyEqual(*s, *c)) {
+                keep = c;
+                break;
+            }
+        }
+        if (!keep) {
+            bucket.push_back(s);
+            continue;
+        }
+        if (diag)
+            *diag << "[info] " << makeModuleKey(s->mName.str(), s->mEnv)
+                  << " merged into "
+                  << makeModuleKey(keep->mName.str(), keep->mEnv) << "\n";
+        ModuleSpec stub;
+        stub.mName = s->mName;
+        stub.mDecl = s->mDecl;
+        stub.mEnv = std::move(s->mEnv);
+        stub.mBitMap.mConn = net::Connectivity{s->mBitMap.mConn.mode()};
+        stub.mAliasOf = keep;
+        *s = std::move(stub);
+        ++st.mMerged;
+    }
+
+    // Earlier stubs may point at specs merged just now.
+    for (auto& [key, s] : lib)
+        if (s.mAliasOf) s.mAliasOf = const_cast<ModuleSpec*>(canonical(&s));
+
+    // Rebuild where-used edges from the surviving specs.
+    for (auto& [key, s] : lib)
+        s.mUsers.clear();
+    for (auto& [key, s] : lib) {
+        for (uint32_t i = 0; i < s.mInstances.size(); ++i)
+            if (const auto* c = s.mInstances[i].mCallee)
+                c->mUsers.push_back(SpecUse{&s, i});
+    }
+    // Frozen views of the survivors still point at merged callees; tables
+    // first, since the fanout index reads them.
+    for (auto& [key, s] : lib)
+        if (!s.mAliasOf && s.mInstTable.built()) s.mInstTable.build(s);
+    for (auto& [key, s] : lib)
+        if (!s.mAliasOf && s.mFanout.built()) s.mFanout.build(s);
+
+    for (auto& [key, s] : lib)
+        st.mBytesAfter += s.memoryBytes();
+    return st;
+}
+
+} // namespace hdl::elab
@@ -0,0 +1,68 @@
+#include "hdl/elab/inst_table.hpp"
+
+#include <unordered_map>
+
+#include "hdl/elab/spec.hpp"
+
+namespace hdl::elab {
+
+void InstanceTable::build(const ModuleSpec& spec, size_t packMin) {
+    clear();
+    const uint32_t n = static_cast<uint32_t>(spec.mInstances.size());
+    mNames.reserve(n);
+    mCallees.reserve(n);
+    mConnOffsets.reserve(static_cast<size_t>(n) + 1);
+    mConnOffsets.push_back(0);
+
+    // Size the shared pin array up front: one allocation.
+    std::unordered_map<const ModuleSpec*, uint32_t> ids;
+    std::vector<uint32_t> portBits;
+    size_t total = 0;
+    for (const auto& inst : spec.mInstances) {
+        auto [it, fresh] =
+          ids.emplace(inst.mCallee, static_cast<uint32_t>(ids.size()));
+        if (fresh) {
+            uint32_t w = 0;
+            if (inst.mCallee)
+                for (const auto& p : inst.mCallee->mPorts)
+                    w += p.width();
+            mCalleeSpecs.push_back(inst.mCallee);
+            portBits.push_back(w);
+        }
+        mCallees.push_back(it->second);
+        total += portBits[it->second];
+    }
+    std::vector<net::BitId> bits(total, kOpenPin);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        const InstanceSpec& inst = spec.mInstances[i];
+        uint32_t base = mConnOffsets.back();
+        mNames.push_back(inst.mName);
+        mConnOffsets.push_back(base + portBits[mCallees[i]]);
+        if (!inst.mCallee) continue;
+        const auto& cbm = inst.mCallee->mBitMap;
+        for (const auto& c : inst.mConns)
+            for (uint32_t k = 0; k < c.mActual.size(); ++k)
+                bits[base + cbm.portBit(c.mFormalIndex, k)] =
+                  spec.atomBit(c.mActual[k]);
+    }
+
+    if (bits.size() >= packMin && !bits.empty()) {
+        net::PackedBitArray p(bits);
+        if (p.memoryBytes() < bits.size() * sizeof(net::BitId)) {
+            mPacked = std::move(p);
+            return;
+        }
+    }
+    mBits = std::move(bits);
+}
+
+size_t InstanceTable::memoryBytes() const {
+    return mNames.capacity() * sizeof(IdString) +
+           (mCallees.capacity() + mConnOffsets.capacity()) *
+             sizeof(uint32_t) +
+           mCalleeSpecs.capacity() * sizeof(const ModuleSpec*) +
+           mBits.memoryBytes() + mPacked.memoryBytes();
+}
+
+} // namespace hdl::elab
@@ -0,0 +1,204 @@
+#include "hdl/elab/lint.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <string>
+#include <thread>
+
+namespace hdl::elab {
+
+const char* to_string(LintKind k) {
+    switch (k) {
+    case LintKind::Undriven:
+        return "undriven";
+    case LintKind::MultiDriven:
+        return "multi-driven";
+    case LintKind::FloatingOutput:
+        return "floating-output";
+    case LintKind::UnusedWire:
+        return "unused-wire";
+    case LintKind::WidthMismatch:
+        return "width-mismatch";
+    }
+    return "?";
+}
+
+bool parseLintKind(std::string_view s, LintKind& out) {
+    for (size_t k = 0; k < kLintKinds; ++k) {
+        if (s == to_string(static_cast<LintKind>(k))) {
+            out = static_cast<LintKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<const LintRow*> LintTable::select(LintKind k) const {
+    std::vector<const LintRow*> r;
+    r.reserve(count(k));
+    for (const auto& row : mRows)
+        if (row.mKind == k) r.push_back(&row);
+    return r;
+}
+
+std::string LintTable::describe(const LintRow& r) {
+    const ModuleSpec& s = *r.mSpec;
+    switch (r.mKind) {
+    case LintKind::Undriven:
+    case LintKind::FloatingOutput:
+        return s.renderBit(r.mItem);
+    case LintKind::MultiDriven:
+        return s.renderBit(r.mItem) + " drivers=" + std::to_string(r.mCount);
+    case LintKind::UnusedWire:
+        return "wire " + s.mWires[r.mItem].mName.str() +
+               " bits=" + std::to_string(r.mCount);
+    case LintKind::WidthMismatch: {
+        const auto& w = s.mWidthMismatches[r.mItem];
+        std::string where =
+          w.mInstance.valid()
+            ? w.mInstance.str() + "." + w.mFormal.str()
+            : "assign #" + std::to_string(w.mAssignIndex);
+        return where + " expected=" + std::to_string(w.mExpected) +
+               " actual=" + std::to_string(w.mActual);
+    }
+    }
+    return {};
+}
+
+namespace {
+
+using Words = std::vector<uint64_t>;
+
+// Bit n set iff off[n + 1] - off[n] > min. Plain loops over dense arrays
+// so the compiler can vectorize the differences.
+void countMask(std::span<const uint32_t> off, uint32_t nets, uint32_t min,
+               Words& out) {
+    out.assign((nets + 63) / 64, 0);
+    for (uint32_t base = 0; base < nets; base += 64) {
+        uint32_t end = std::min(nets, base + 64);
+        uint64_t w = 0;
+        for (uint32_t n = base; n < end; ++n)
+            w |= uint64_t(off[n + 1] - off[n] > min) << (n - base);
+        out[base / 64] = w;
+    }
+}
+
+bool inoutEndpoint(const ModuleSpec& spec, const NetEndpoint& ep) {
+    if (ep.mKind == EndpointKind::Port)
+        return spec.mPorts[ep.mIndex].mDir == PortDirection::InOut;
+    if (ep.mKind == EndpointKind::ChildPin)
+        return spec.mInstances[ep.mIndex].mCallee->mPorts[ep.mPort].mDir ==
+               PortDirection::InOut;
+    if (ep.mKind == EndpointKind::Cell)
+        return spec.mPrims.type(ep.mIndex).mPins[ep.mPort].mDir ==
+               PortDirection::InOut;
+    return false;
+}
+
+void lintSpec(const ModuleSpec& spec, std::vector<LintRow>& rows) {
+    for (uint32_t i = 0; i < spec.mWidthMismatches.size(); ++i)
+        rows.push_back(LintRow{&spec, LintKind::WidthMismatch, i, 0});
+    const auto& fo = spec.mFanout;
+    if (!fo.built()) return;
+    const auto& bm = spec.mBitMap;
+    const uint32_t nets = fo.netCount();
+
+    Words driven, multi, loaded, outNet;
+    countMask(fo.mDriverOffsets.span(), nets, 0, driven);
+    countMask(fo.mDriverOffsets.span(), nets, 1, multi);
+    countMask(fo.mLoadOffsets.span(), nets, 0, loaded);
+    outNet.assign(driven.size(), 0);
+    // Black boxes (no body) have nothing that could drive their outputs.
+    bool blackBox = spec.mInstances.empty() && spec.mPrims.empty() &&
+                    (!spec.mDecl || spec.mDecl->mAssigns.empty());
+    for (uint32_t p = 0; p < spec.mPorts.size(); ++p) {
+        if (spec.mPorts[p].mDir != PortDirection::Out) continue;
+        for (uint32_t k = 0; k < spec.mPorts[p].width(); ++k) {
+            net::NetId n = bm.netOf(bm.portBit(p, k));
+            outNet[n / 64] |= uint64_t(1) << (n % 64);
+        }
+    }
+
+    // Representative bit of a net: its smallest member.
+    auto first = [&](net::NetId n) { return bm.netGroups()[n][0]; };
+    auto emit = [&](const Words& mask, auto&& fn) {
+        for (size_t w = 0; w < mask.size(); ++w)
+            for (uint64_t m = mask[w]; m; m &= m - 1)
+                fn(static_cast<net::NetId>(w * 64 + std::countr_zero(m)));
+    };
+
+    Words undriven(driven.size()), floating(driven.size());
+    for (size_t w = 0; w < driven.size(); ++w) {
+        floating[w] = blackBox ? 0 : outNet[w] & ~driven[w];
+        undriven[w] = loaded[w] & ~driven[w] & ~outNet[w];
+    }
+    emit(undriven, [&](net::NetId n) {
+        rows.push_back(LintRow{&spec, LintKind::Undriven, first(n), 0});
+    });
+    emit(multi, [&](net::NetId n) {
+        // Inout endpoints may legitimately share a net.
+        uint32_t strong = 0;
+        for (const auto& ep : fo.drivers(n))
+            strong += !inoutEndpoint(spec, ep);
+        if (strong > 1)
+            rows.push_back(
+              LintRow{&spec, LintKind::MultiDriven, first(n), strong});
+    });
+    emit(floating, [&](net::NetId n) {
+        rows.push_back(LintRow{&spec, LintKind::FloatingOutput, first(n), 0});
+    });
+
+    // A wire is unused when none of its bits' nets has any endpoint.
+    for (uint32_t w = 0; w < spec.mWires.size(); ++w) {
+        uint32_t width = spec.mWires[w].width();
+        if (width == 0) continue;
+        uint32_t idle = 0;
+        for (uint32_t k = 0; k < width; ++k) {
+            net::NetId n = bm.netOf(bm.wireBit(w, k));
+            uint64_t bit = uint64_t(1) << (n % 64);
+            idle += !((driven[n / 64] | loaded[n / 64]) & bit);
+        }
+        if (idle == width)
+            rows.push_back(LintRow{&spec, LintKind::UnusedWire, w, width});
+    }
+}
+
+} // namespace
+
+LintTable runLint(std::span<const ModuleSpec* const> specs,
+                  unsigned threads) {
+    std::vector<std::vector<LintRow>> parts(specs.size());
+    unsigned t = threads ? threads : std::thread::hardware_concurrency();
+    t = static_cast<unsigned>(
+      std::clamp<size_t>(t, 1, std::max<size_t>(1, specs.size())));
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < specs.size();)
+            lintSpec(*specs[i], parts[i]);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < t; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    LintTable table;
+    size_t total = 0;
+    for (const auto& p : parts)
+        total += p.size();
+    table.mRows.reserve(total);
+    for (auto& p : parts) {
+        // Group by kind within a spec; items stay ascending.
+        std::stable_sort(p.begin(), p.end(), [](const auto& a, const auto& b) {
+            return a.mKind < b.mKind;
+        });
+        for (const auto& r : p)
+            ++table.mCounts[size_t(r.mKind)];
+        table.mRows.insert(table.mRows.end(), p.begin(), p.end());
+    }
+    return table;
+}
+
+} // namespace hdl::elab
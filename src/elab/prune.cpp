@@ -0,0 +1,108 @@
+#include "hdl/elab/prune.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "hdl/elab/flatten.hpp"
+
+namespace hdl::elab {
+
+PruneStats pruneDeadWires(ModuleSpec& spec) {
+    PruneStats st;
+    st.mBytesBefore = spec.memoryBytes();
+    st.mBytesAfter = st.mBytesBefore;
+
+    // Mark referenced wires by their atoms; bindings are already flat.
+    std::vector<bool> live(spec.mWires.size(), false);
+    auto mark = [&](const BitVector& v) {
+        for (const auto& a : v) {
+            if (a.mKind != BitAtomKind::WireBit) continue;
+            int w = spec.findWireIndex(a.mOwnerIndex);
+            if (w >= 0) live[w] = true;
+        }
+    };
+    for (const auto& inst : spec.mInstances)
+        for (const auto& c : inst.mConns)
+            mark(c.mActual);
+    for (net::BitId b : spec.mPrims.mPinBits) {
+        net::BitOwnerRef ref;
+        if (b != PrimTable::kOpenPin && spec.mBitMap.ownerOf(b, ref) &&
+            ref.mKind == net::BitOwnerRef::Kind::Wire)
+            live[ref.mOwnerIndex] = true;
+    }
+    if (spec.mDecl) {
+        FlattenContext fc(spec, nullptr);
+        for (const auto& asg : spec.mDecl->mAssigns) {
+            mark(fc.flattenExpr(asg.mLhs));
+            mark(fc.flattenExpr(asg.mRhs));
+        }
+    }
+    if (std::find(live.begin(), live.end(), false) == live.end()) return st;
+
+    // Compact mWires; old -> new wire index.
+    std::vector<uint32_t> newIdx(spec.mWires.size(), ModuleSpec::kPrunedWire);
+    std::vector<WireSpec> kept;
+    for (uint32_t w = 0; w < spec.mWires.size(); ++w) {
+        if (live[w]) {
+            newIdx[w] = static_cast<uint32_t>(kept.size());
+            kept.push_back(spec.mWires[w]);
+        } else {
+            ++st.mWires;
+            st.mBits += spec.mWires[w].width();
+            spec.mPrunedWires.emplace(spec.mWires[w].mName, spec.mWires[w]);
+        }
+    }
+    if (spec.mWireRemap.empty()) {
+        spec.mWireRemap.resize(spec.mWires.size());
+        std::iota(spec.mWireRemap.begin(), spec.mWireRemap.end(), 0u);
+    }
+    for (auto& r : spec.mWireRemap)
+        if (r != ModuleSpec::kPrunedWire) r = newIdx[r];
+
+    net::BitMap old = std::move(spec.mBitMap);
+    std::vector<uint32_t> oldWireIdx;
+    for (uint32_t w = 0; w < newIdx.size(); ++w)
+        if (newIdx[w] != ModuleSpec::kPrunedWire) oldWireIdx.push_back(w);
+    spec.mWires = std::move(kept);
+    spec.mWireIndex.clear();
+    for (uint32_t w = 0; w < spec.mWires.size(); ++w)
+        spec.mWireIndex.emplace(spec.mWires[w].mName, w);
+
+    net::BitMap& bm = spec.mBitMap;
+    bm = net::BitMap{};
+    bm.setUnionFindMode(old.mConn.mode());
+    bm.build(spec);
+
+    // Old bit -> new bit (UINT32_MAX for pruned bits), then replay each
+    // old net onto its surviving members.
+    std::vector<net::BitId> map(old.mConn.size(), UINT32_MAX);
+    for (uint32_t p = 0; p < spec.mPorts.size(); ++p)
+        for (uint32_t k = 0; k < spec.mPorts[p].width(); ++k)
+            map[old.portBit(p, k)] = bm.portBit(p, k);
+    for (uint32_t w = 0; w < spec.mWires.size(); ++w)
+        for (uint32_t k = 0; k < spec.mWires[w].width(); ++k)
+            map[old.wireBit(oldWireIdx[w], k)] = bm.wireBit(w, k);
+    for (bool one : {false, true})
+        map[old.tieBit(one)] = bm.tieBit(one);
+    for (auto bits : old.netGroups()) {
+        net::BitId first = UINT32_MAX;
+        for (net::BitId b : bits) {
+            if (map[b] == UINT32_MAX) continue;
+            if (first == UINT32_MAX) first = map[b];
+            else bm.alias(first, map[b]);
+        }
+    }
+    bm.freeze();
+    for (net::BitId& b : spec.mPrims.mPinBits)
+        if (b != PrimTable::kOpenPin) b = map[b];
+    for (ConstDriver& d : spec.mConstDrivers)
+        d.mBit = map[d.mBit]; // assigned wires are live
+    if (spec.mInstTable.built()) spec.mInstTable.build(spec);
+    if (spec.mFanout.built()) spec.mFanout.build(spec);
+
+    st.mBytesAfter = spec.memoryBytes();
+    return st;
+}
+
+} // namespace hdl::elab
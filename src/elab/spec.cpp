@@ -9,6 +9,10 @@ int ModuleSpec::findWireIndex(IdString n) const {
     auto it = mWireIndex.find(n);
     return it == mWireIndex.end() ? -1 : static_cast<int>(it->second);
 }
+int ModuleSpec::findInstanceIndex(IdString n) const {
+    auto it = mInstanceIndex.find(n);
+    return it == mInstanceIndex.end() ? -1 : static_cast<int>(it->second);
+}
 
 net::BitId ModuleSpec::portBit(IdString name, uint32_t bitOff) const {
     int idx = findPortIndex(name);
@@ -24,6 +28,20 @@ net::BitId ModuleSpec::wireBit(IdString name, uint32_t bitOff) const {
     return mBitMap.wireBit(static_cast<uint32_t>(idx), bitOff);
 }
 
+net::BitId ModuleSpec::atomBit(const BitAtom& a) const {
+    if (a.mKind == BitAtomKind::PortBit) {
+        int idx = findPortIndex(a.mOwnerIndex);
+        if (idx < 0) return UINT32_MAX;
+        return mBitMap.portBit(static_cast<uint32_t>(idx), a.mBitIndex);
+    }
+    if (a.mKind == BitAtomKind::WireBit) {
+        int idx = findWireIndex(a.mOwnerIndex);
+        if (idx < 0) return UINT32_MAX;
+        return mBitMap.wireBit(static_cast<uint32_t>(idx), a.mBitIndex);
+    }
+    return mBitMap.tieBit(a.mKind == BitAtomKind::Const1);
+}
+
 void ModuleSpec::dumpLayout(std::ostream& os) {
     os << "ModuleSpec " << mName.str() << " layout:\n";
     os << "  Ports:\n";
@@ -49,4 +67,30 @@ void ModuleSpec::dumpConnectivity(std::ostream& os) {
 std::string ModuleSpec::renderBit(net::BitId b) const {
     return mBitMap.renderBit(*this, b);
 }
+
+size_t ModuleSpec::memoryBytes() const {
+    // Hash map nodes: key/value plus a next pointer and a bucket slot.
+    auto mapBytes = [](const auto& m) {
+        using V = typename std::decay_t<decltype(m)>::value_type;
+        return m.size() * (sizeof(V) + sizeof(void*)) +
+               m.bucket_count() * sizeof(void*);
+    };
+    size_t n = sizeof(ModuleSpec) + mBitMap.memoryBytes() - sizeof(mBitMap) +
+               mFanout.memoryBytes() + mPrims.memoryBytes() +
+               mInstTable.memoryBytes();
+    n += mInstances.capacity() * sizeof(InstanceSpec);
+    for (const auto& inst : mInstances) {
+        n += inst.mConns.capacity() * sizeof(ConnSpec);
+        for (const auto& c : inst.mConns)
+            n += c.mActual.capacity() * sizeof(BitAtom);
+    }
+    n += mPorts.capacity() * sizeof(PortSpec) +
+         mWires.capacity() * sizeof(WireSpec) +
+         mUsers.capacity() * sizeof(SpecUse) +
+         mConstDrivers.capacity() * sizeof(ConstDriver);
+    n += mapBytes(mPortIndex) + mapBytes(mWireIndex) +
+         mapBytes(mInstanceIndex) + mapBytes(mEnv) +
+         mapBytes(mPrunedWires) + mWireRemap.capacity() * sizeof(uint32_t);
+    return n;
+}
 } // namespace hdl::elab
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "hdl/hier/cone.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "hdl/common.hpp"
+#include "hdl/hier/global_net.hpp"
+#include "hdl/hier/port_model.hpp"
+
+namespace hdl::elab::hier {
+
+bool isOpaqueLeaf(const ModuleSpec& spec) {
+    if (!spec.mInstances.empty() || !spec.mPrims.empty()) return false;
+    return !spec.mDecl || spec.mDecl->mAssigns.empty() ||
+           !spec.mFanout.built();
+}
+
+namespace {
+
+constexpr net::BitId kNone = UINT32_MAX;
+
+enum class StepKind : uint8_t { Net, Child, Cross, Cell, TopPort };
+
+// Successor candidate. Net: (mScope, mA). Child/Cross: pin (mA port, mB
+// bit) of instance mInst under mScope. Cell: pin mA of primitive mInst
+// under mScope. TopPort: (mA port, mB bit).
+struct Step {
+    StepKind mKind = StepKind::Net;
+    ScopeHandle mScope = kRootScope;
+    uint32_t mInst = 0;
+    uint32_t mA = 0;
+    uint32_t mB = 0;
+};
+
+// Reads the scope table and specs only; safe to run from many threads
+// while nothing is being interned.
+void expand(const ScopeTable& scopes, const ConeNet& cn, ConeDir dir,
+            std::vector<Step>& out) {
+    const ModuleSpec& spec = scopes.spec(cn.mScope);
+    if (!spec.mFanout.built()) return;
+    auto eps = dir == ConeDir::Fanout ? spec.mFanout.loads(cn.mNet)
+                                      : spec.mFanout.drivers(cn.mNet);
+    for (const NetEndpoint& ep : eps) {
+        switch (ep.mKind) {
+        case EndpointKind::Port: {
+            if (cn.mScope == kRootScope) {
+                out.push_back(
+                  Step{StepKind::TopPort, kRootScope, 0, ep.mIndex, ep.mBit});
+                break;
+            }
+            ScopeHandle up = scopes.parent(cn.mScope);
+            const ModuleSpec& parent = scopes.spec(up);
+            net::BitId pb =
+              boundParentBit(parent,
+                             *scopes.instance(cn.mScope),
+                             spec.mBitMap.portBit(ep.mIndex, ep.mBit));
+            if (pb != kNone)
+                out.push_back(
+                  Step{StepKind::Net, up, 0, parent.mBitMap.netOf(pb), 0});
+            break;
+        }
+        case EndpointKind::ChildPin: {
+            const ModuleSpec* callee = spec.mInstances[ep.mIndex].mCallee;
+            out.push_back(Step{isOpaqueLeaf(*callee) ? StepKind::Cross
+                                                     : StepKind::Child,
+                               cn.mScope,
+                               ep.mIndex,
+                               ep.mPort,
+                               ep.mBit});
+            break;
+        }
+        case EndpointKind::Cell:
+            out.push_back(
+              Step{StepKind::Cell, cn.mScope, ep.mIndex, ep.mPort, 0});
+            break;
+        case EndpointKind::Const:
+            break;
+        }
+    }
+}
+
+class Tracer {
+  public:
+    Tracer(ScopeTable& scopes, const ConeOptions& opts, ConeResult& out)
+        : mScopes(scopes)
+        , mOpts(opts)
+        , mOut(out) {
+        mThreads = opts.mThreads ? opts.mThreads
+                                 : std::thread::hardware_concurrency();
+        mThreads = std::max(1u, mThreads);
+    }
+
+    bool visit(ScopeHandle s, net::NetId n) {
+        auto& bits = mVisited[s];
+        if (bits.empty())
+            bits.resize((mScopes.spec(s).mBitMap.netCount() + 63) / 64);
+        uint64_t m = uint64_t(1) << (n & 63);
+        if (bits[n >> 6] & m) return false;
+        bits[n >> 6] |= m;
+        mOut.mNets.push_back(ConeNet{s, n});
+        return true;
+    }
+
+    void run(ConeNet start) {
+        std::vector<ConeNet> frontier, same, next;
+        if (visit(start.mScope, start.mNet)) frontier.push_back(start);
+        uint32_t level = 0;
+        while (!frontier.empty()) {
+            // Zero-cost moves stay on this level.
+            while (!frontier.empty()) {
+                expandAll(frontier);
+                same.clear();
+                intern(level, same, next);
+                frontier.swap(same);
+            }
+            if (next.empty()) break;
+            mOut.mLevels = ++level;
+            frontier.swap(next);
+            next.clear();
+        }
+    }
+
+  private:
+    void expandAll(const std::vector<ConeNet>& frontier) {
+        mSteps.clear();
+        unsigned t = mThreads;
+        if (frontier.size() < mOpts.mParallelMin || t <= 1) {
+            for (const auto& cn : frontier)
+                expand(mScopes, cn, mOpts.mDir, mSteps);
+            return;
+        }
+        t = static_cast<unsigned>(std::min<size_t>(t, frontier.size()));
+        std::vector<std::vector<Step>> parts(t);
+        std::vector<std::thread> pool;
+        size_t chunk = (frontier.size() + t - 1) / t;
+        for (unsigned i = 0; i < t; ++i) {
+            pool.emplace_back([&, i] {
+                size_t b = i * chunk;
+                size_t e = std::min(frontier.size(), b + chunk);
+                for (size_t k = b; k < e; ++k)
+                    expand(mScopes, frontier[k], mOpts.mDir, parts[i]);
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+        for (auto& p : parts)
+            mSteps.insert(mSteps.end(), p.begin(), p.end());
+    }
+
+    void intern(uint32_t level, std::vector<ConeNet>& same,
+                std::vector<ConeNet>& next) {
+        for (const Step& s : mSteps) {
+            switch (s.mKind) {
+            case StepKind::Net:
+                if (visit(s.mScope, s.mA)) same.push_back({s.mScope, s.mA});
+                break;
+            case StepKind::Child: {
+                if (mOpts.mModels) {
+                    jump(s, same);
+                    break;
+                }
+                ScopeHandle h = mScopes.child(s.mScope, s.mInst);
+                const auto& bm = mScopes.spec(h).mBitMap;
+                net::NetId n = bm.netOf(bm.portBit(s.mA, s.mB));
+                if (visit(h, n)) same.push_back({h, n});
+                break;
+            }
+            case StepKind::Cross:
+                cross(s, level, next);
+                break;
+            case StepKind::Cell:
+                crossCell(s, level, next);
+                break;
+            case StepKind::TopPort:
+                mOut.mPins.push_back(ConePin{kRootScope, s.mA, s.mB});
+                break;
+            }
+        }
+    }
+
+    // Abstract child: continue in the parent from every port bit the
+    // child's model connects to this pin.
+    void jump(const Step& s, std::vector<ConeNet>& same) {
+        const ModuleSpec& parent = mScopes.spec(s.mScope);
+        const InstanceSpec& inst = parent.mInstances[s.mInst];
+        const ModuleSpec& callee = *inst.mCallee;
+        const PortModel& m = mOpts.mModels->model(callee);
+        net::BitId from = callee.mBitMap.portBit(s.mA, s.mB);
+        for (const BitRange& r : m.reach(from, mOpts.mDir == ConeDir::Fanout)) {
+            for (net::BitId b = r.mLo; b < r.mHi; ++b) {
+                net::BitId pb = boundParentBit(parent, inst, b);
+                if (pb == kNone) continue;
+                net::NetId n = parent.mBitMap.netOf(pb);
+                if (visit(s.mScope, n)) same.push_back({s.mScope, n});
+            }
+        }
+    }
+
+    // Opaque leaf: every pin on the far side continues in the parent.
+    void cross(const Step& s, uint32_t level, std::vector<ConeNet>& next) {
+        ScopeHandle h = mScopes.child(s.mScope, s.mInst);
+        mOut.mPins.push_back(ConePin{h, s.mA, s.mB});
+        if (level >= mOpts.mMaxDepth || !mCrossed.insert(h).second) return;
+        const ModuleSpec& parent = mScopes.spec(s.mScope);
+        const InstanceSpec& inst = parent.mInstances[s.mInst];
+        const ModuleSpec& leaf = *inst.mCallee;
+        PortDirection skip = mOpts.mDir == ConeDir::Fanout
+                               ? PortDirection::In
+                               : PortDirection::Out;
+        for (uint32_t p = 0; p < leaf.mPorts.size(); ++p) {
+            if (leaf.mPorts[p].mDir == skip) continue;
+            for (uint32_t k = 0; k < leaf.mPorts[p].width(); ++k) {
+                net::BitId pb =
+                  boundParentBit(parent, inst, leaf.mBitMap.portBit(p, k));
+                if (pb == kNone) continue;
+                net::NetId n = parent.mBitMap.netOf(pb);
+                if (visit(s.mScope, n)) next.push_back({s.mScope, n});
+            }
+        }
+    }
+
+    // Primitive cell: continue from the pins its arcs reach (every pin on
+    // the far side for an opaque cell). Cell pins have no scope and are
+    // not reported in mPins.
+    void crossCell(const Step& s, uint32_t level, std::vector<ConeNet>& next) {
+        if (level >= mOpts.mMaxDepth) return;
+        const ModuleSpec& spec = mScopes.spec(s.mScope);
+        const CellType& ct = spec.mPrims.type(s.mInst);
+        auto pins = spec.mPrims.pins(s.mInst);
+        bool fwd = mOpts.mDir == ConeDir::Fanout;
+        auto go = [&](uint32_t p) {
+            if (pins[p] == PrimTable::kOpenPin) return;
+            net::NetId n = spec.mBitMap.netOf(pins[p]);
+            if (visit(s.mScope, n)) next.push_back({s.mScope, n});
+        };
+        if (!ct.opaque()) {
+            for (const CellArc& a : ct.mArcs)
+                if ((fwd ? a.mFrom : a.mTo) == s.mA) go(fwd ? a.mTo : a.mFrom);
+            return;
+        }
+        PortDirection skip = fwd ? PortDirection::In : PortDirection::Out;
+        for (uint32_t p = 0; p < ct.mPins.size(); ++p)
+            if (ct.mPins[p].mDir != skip) go(p);
+    }
+
+    ScopeTable& mScopes;
+    const ConeOptions& mOpts;
+    ConeResult& mOut;
+    unsigned mThreads = 1;
+    std::vector<Step> mSteps;
+    std::unordered_map<ScopeHandle, std::vector<uint64_t>> mVisited;
+    std::unordered_set<ScopeHandle> mCrossed;
+};
+
+} // namespace
+
+bool traceCone(ScopeTable& scopes, ScopeHandle scope, net::BitId bit,
+               const ConeOptions& opts, ConeResult& out,
+               std::ostream* diag) {
+    out = ConeResult{};
+    if (scope == kInvalidScope || scope >= scopes.size()) {
+        error(diag, "invalid scope handle");
+        return false;
+    }
+    const ModuleSpec* spec = &scopes.spec(scope);
+    if (bit >= spec->mBitMap.mConn.size()) {
+        error(diag, "bit " + std::to_string(bit) + " out of range");
+        return false;
+    }
+    if (scope != kRootScope && isOpaqueLeaf(*spec)) {
+        ScopeHandle up = scopes.parent(scope);
+        net::BitId pb =
+          boundParentBit(scopes.spec(up), *scopes.instance(scope), bit);
+        if (pb != kNone) {
+            scope = up;
+            bit = pb;
+            spec = &scopes.spec(up);
+        }
+    }
+    Tracer t(scopes, opts, out);
+    t.run(ConeNet{scope, spec->mBitMap.netOf(bit)});
+    return true;
+}
+
+} // namespace hdl::elab::hier
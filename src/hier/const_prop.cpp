@@ -0,0 +1,143 @@
+#include "hdl/hier/const_prop.hpp"
+
+#include <bit>
+
+#include "hdl/hier/port_model.hpp"
+#include "hdl/hier/rollup.hpp"
+
+namespace hdl::elab::hier {
+
+const char* to_string(ConstVal v) {
+    switch (v) {
+    case ConstVal::Unknown:
+        return "unknown";
+    case ConstVal::Zero:
+        return "0";
+    case ConstVal::One:
+        return "1";
+    case ConstVal::Conflict:
+        return "conflict";
+    }
+    return "?";
+}
+
+namespace {
+
+constexpr net::BitId kNone = UINT32_MAX;
+
+struct Edge {
+    net::NetId mFrom;
+    net::NetId mTo;
+};
+
+void propagate(const ModuleSpec& spec,
+               const std::unordered_map<const ModuleSpec*, SpecConsts>& done,
+               PortModelCache& models, SpecConsts& out) {
+    const auto& bm = spec.mBitMap;
+    const net::NetId nets = bm.netCount();
+    const size_t words = (nets + 63) / 64;
+    out.mKnown0.assign(words, 0);
+    out.mKnown1.assign(words, 0);
+    auto set = [&](std::vector<uint64_t>& v, net::NetId n) {
+        uint64_t m = uint64_t(1) << (n & 63);
+        bool had = v[n >> 6] & m;
+        v[n >> 6] |= m;
+        return !had;
+    };
+
+    std::vector<net::NetId> work;
+    if (set(out.mKnown0, bm.netOf(bm.tieBit(false))))
+        work.push_back(bm.netOf(bm.tieBit(false)));
+    if (set(out.mKnown1, bm.netOf(bm.tieBit(true))))
+        work.push_back(bm.netOf(bm.tieBit(true)));
+    for (const ConstDriver& d : spec.mConstDrivers) {
+        net::NetId n = bm.netOf(d.mBit);
+        if (set(d.mOne ? out.mKnown1 : out.mKnown0, n)) work.push_back(n);
+    }
+
+    std::vector<Edge> edges;
+    const InstanceTable& it = spec.mInstTable;
+    std::vector<net::BitId> scratch;
+    for (uint32_t n = 0; n < it.size(); ++n) {
+        if (!it.callee(n)) continue;
+        const ModuleSpec& callee = *it.callee(n);
+        const SpecConsts& cc = done.at(&callee);
+        const PortModel& m = models.model(callee);
+        auto bound = it.bits(n).decode(scratch);
+        net::BitId cb = 0;
+        for (const auto& port : callee.mPorts) {
+            bool drives = port.mDir != PortDirection::In;
+            for (uint32_t k = 0; k < port.width(); ++k, ++cb) {
+                net::BitId pb = bound[cb];
+                if (pb == kNone || !drives) continue;
+                // Constants from inside the child.
+                net::NetId pn = bm.netOf(pb);
+                ConstVal v = cc.of(callee.mBitMap.netOf(cb));
+                bool grew = false;
+                if (v == ConstVal::Zero || v == ConstVal::Conflict)
+                    grew |= set(out.mKnown0, pn);
+                if (v == ConstVal::One || v == ConstVal::Conflict)
+                    grew |= set(out.mKnown1, pn);
+                if (grew) work.push_back(pn);
+            }
+        }
+        for (net::BitId i = 0; i < m.mPortBits; ++i) {
+            if (bound[i] == kNone) continue;
+            for (const auto& r : m.reach(i, true))
+                for (net::BitId o = r.mLo; o < r.mHi; ++o)
+                    if (bound[o] != kNone)
+                        edges.push_back(
+                          Edge{bm.netOf(bound[i]), bm.netOf(bound[o])});
+        }
+    }
+
+    // CSR over feedthrough edges, then a worklist until nothing grows.
+    std::vector<uint32_t> off(static_cast<size_t>(nets) + 1, 0);
+    for (const auto& e : edges)
+        ++off[e.mFrom + 1];
+    for (net::NetId n = 0; n < nets; ++n)
+        off[n + 1] += off[n];
+    std::vector<net::NetId> adj(edges.size());
+    {
+        std::vector<uint32_t> cur(off.begin(), off.end() - 1);
+        for (const auto& e : edges)
+            adj[cur[e.mFrom]++] = e.mTo;
+    }
+    while (!work.empty()) {
+        net::NetId a = work.back();
+        work.pop_back();
+        ConstVal v = out.of(a);
+        for (uint32_t e = off[a]; e < off[a + 1]; ++e) {
+            bool grew = false;
+            if (v == ConstVal::Zero || v == ConstVal::Conflict)
+                grew |= set(out.mKnown0, adj[e]);
+            if (v == ConstVal::One || v == ConstVal::Conflict)
+                grew |= set(out.mKnown1, adj[e]);
+            if (grew) work.push_back(adj[e]);
+        }
+    }
+
+    // Word-wise classification; the tie nets themselves are not counted
+    // unless something else joined them.
+    for (size_t w = 0; w < words; ++w) {
+        out.mConstNets += std::popcount(out.mKnown0[w] ^ out.mKnown1[w]);
+        out.mConflictNets += std::popcount(out.mKnown0[w] & out.mKnown1[w]);
+    }
+    for (bool one : {false, true}) {
+        net::NetId n = bm.netOf(bm.tieBit(one));
+        if (bm.netGroups()[n].size() == 1 && out.of(n) != ConstVal::Conflict)
+            --out.mConstNets;
+    }
+}
+
+} // namespace
+
+ConstTable::ConstTable(const ModuleSpec& top, std::ostream* diag) {
+    RollupTable rt(top, diag);
+    mOrder = rt.order();
+    PortModelCache models(/*cutOpaque=*/true);
+    for (const ModuleSpec* s : mOrder)
+        propagate(*s, mConsts, models, mConsts[s]);
+}
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,343 @@
+#include "hdl/hier/flat_graph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+#include "hdl/common.hpp"
+#include "hdl/hier/rollup.hpp"
+
+namespace hdl::elab::hier {
+
+IdString FlatLeaf::name() const {
+    return mPrim ? mParent->mPrims.mNames[mIndex]
+                 : mParent->mInstances[mIndex].mName;
+}
+
+size_t FlatGraph::memoryBytes() const {
+    return mInsts.capacity() * sizeof(FlatLeaf) +
+           (mInstPinBase.capacity() + mPinInst.capacity() +
+            mPinNet.capacity() + mNetPinOffsets.capacity() +
+            mNetPins.capacity()) *
+             sizeof(uint32_t);
+}
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+
+bool isLeaf(const ModuleSpec& spec) {
+    return spec.mInstances.empty() && spec.mPrims.empty();
+}
+
+uint32_t openPrimPins(const ModuleSpec& spec) {
+    return static_cast<uint32_t>(std::count(spec.mPrims.mPinBits.begin(),
+                                            spec.mPrims.mPinBits.end(),
+                                            PrimTable::kOpenPin));
+}
+
+uint32_t portBitCount(const ModuleSpec& spec) {
+    uint32_t n = 0;
+    for (const auto& p : spec.mPorts)
+        n += p.width();
+    return n;
+}
+
+// Global net ids allocated below a spec's own frame. Ids are handed out in
+// depth-first order: entering an instance allocates one id per callee class
+// that the binding does not connect upwards, then its children follow,
+// then one id per unconnected pin of the callee's own cells. Leaf and pin
+// totals come straight from the rollups.
+struct SpecCounts {
+    const SpecNetSummary* mSummary = nullptr;
+    uint64_t mNets = 0;
+};
+
+struct InstCounts {
+    uint64_t mLeaves = 0;
+    uint64_t mPins = 0;
+    uint64_t mNets = 0;
+};
+
+class Counter {
+  public:
+    Counter(GlobalNetResolver& res, const RollupTable& rollups)
+        : mRes(res)
+        , mRollups(rollups) {}
+
+    const SpecCounts& get(const ModuleSpec& spec) {
+        if (auto it = mCounts.find(&spec); it != mCounts.end())
+            return it->second;
+        SpecCounts c;
+        c.mSummary = &mRes.summary(spec);
+        c.mNets = openPrimPins(spec);
+        for (const auto& inst : spec.mInstances) {
+            if (!inst.mCallee) continue;
+            c.mNets += of(spec, inst).mNets;
+        }
+        return mCounts.emplace(&spec, c).first->second;
+    }
+
+    InstCounts of(const ModuleSpec& parent, const InstanceSpec& inst) {
+        const ModuleSpec& callee = *inst.mCallee;
+        const SpecCounts& cc = get(callee);
+        const SpecNetSummary& cs = *cc.mSummary;
+        InstCounts ic;
+        for (net::NetId c = 0; c < cs.classCount(); ++c) {
+            bool bound = false;
+            for (net::BitId e : cs.exits(c)) {
+                if (boundParentBit(parent, inst, e) != kNone) {
+                    bound = true;
+                    break;
+                }
+            }
+            ic.mNets += !bound;
+        }
+        ic.mNets += cc.mNets;
+        if (isLeaf(callee)) {
+            ic.mLeaves = 1;
+            ic.mPins = portBitCount(callee);
+        } else {
+            const SpecRollup& r = mRollups.of(callee);
+            ic.mLeaves = r.mLeafInstances;
+            ic.mPins = r.mLeafPins;
+        }
+        return ic;
+    }
+
+  private:
+    GlobalNetResolver& mRes;
+    const RollupTable& mRollups;
+    std::unordered_map<const ModuleSpec*, SpecCounts> mCounts;
+};
+
+struct Frame {
+    const ModuleSpec* mSpec = nullptr;
+    const SpecNetSummary* mSummary = nullptr;
+    std::vector<uint32_t> mOwned; // class -> global net id
+    const uint32_t* mIds = nullptr;
+    uint32_t mNext = 0;
+    uint32_t mEnd = 0;
+};
+
+// Map every class of inst's callee to a global id: inherited through a
+// bound port bit, or freshly allocated.
+void enterInstance(const Frame& parent, const InstanceSpec& inst,
+                   const SpecNetSummary& cs, uint32_t& nextNet,
+                   std::vector<uint32_t>& ids) {
+    const ModuleSpec& pspec = *parent.mSpec;
+    ids.assign(cs.classCount(), kNone);
+    for (net::NetId c = 0; c < cs.classCount(); ++c) {
+        for (net::BitId e : cs.exits(c)) {
+            net::BitId pb = boundParentBit(pspec, inst, e);
+            if (pb == kNone) continue;
+            ids[c] = parent.mIds[parent.mSummary->mClassOf[pspec.mBitMap
+                                                              .netOf(pb)]];
+            break;
+        }
+        if (ids[c] == kNone) ids[c] = nextNet++;
+    }
+}
+
+// Appends f's primitive cells as leaves; their pins are local bits of f.
+void emitPrims(const Frame& f, FlatGraph& out, std::vector<uint32_t>& rawNet,
+               uint32_t& instId, uint32_t& pinId, uint32_t& netId) {
+    const ModuleSpec& spec = *f.mSpec;
+    const PrimTable& prims = spec.mPrims;
+    for (uint32_t i = 0; i < prims.size(); ++i, ++instId) {
+        out.mInsts[instId] = FlatLeaf{&spec, i, true};
+        out.mInstPinBase[instId] = pinId;
+        for (net::BitId b : prims.pins(i)) {
+            out.mPinInst[pinId] = instId;
+            rawNet[pinId++] =
+              b == PrimTable::kOpenPin
+                ? netId++
+                : f.mIds[f.mSummary->mClassOf[spec.mBitMap.netOf(b)]];
+        }
+    }
+}
+
+struct Chunk {
+    uint32_t mBegin = 0, mEnd = 0; // top-level instance range
+    uint32_t mInstBase = 0, mPinBase = 0, mNetBase = 0;
+};
+
+} // namespace
+
+bool buildFlatGraph(const ModuleSpec& top, GlobalNetResolver& resolver,
+                    const FlatGraphOptions& opts, FlatGraph& out,
+                    std::ostream* diag) {
+    out.clear();
+    // Summaries and counts are filled sequentially; the parallel phase
+    // below only reads them.
+    RollupTable rollups(top, diag);
+    Counter counter(resolver, rollups);
+    const SpecCounts& tc = counter.get(top);
+    const SpecNetSummary& ts = *tc.mSummary;
+
+    std::vector<InstCounts> perInst(top.mInstances.size());
+    for (size_t k = 0; k < top.mInstances.size(); ++k) {
+        if (top.mInstances[k].mCallee)
+            perInst[k] = counter.of(top, top.mInstances[k]);
+    }
+    const uint64_t insts = rollups.of(top).mLeafInstances;
+    const uint64_t pins = rollups.of(top).mLeafPins;
+    const uint64_t nets = ts.classCount() + tc.mNets;
+    if (pins >= kNone || nets >= kNone) {
+        error(diag, "flat graph exceeds 32-bit ids");
+        return false;
+    }
+    const uint64_t estimate =
+      insts * (sizeof(FlatLeaf) + sizeof(uint32_t)) +
+      pins * 4 * sizeof(uint32_t) + nets * sizeof(uint32_t);
+    if (opts.mMemoryBudget && estimate > opts.mMemoryBudget) {
+        error(diag,
+              "flat graph needs ~" + std::to_string(estimate) +
+                " bytes, over the budget of " +
+                std::to_string(opts.mMemoryBudget));
+        return false;
+    }
+
+    unsigned threads =
+      opts.mThreads ? opts.mThreads : std::thread::hardware_concurrency();
+    threads = std::max(1u, threads);
+
+    // Cut the top-level instances into chunks of roughly equal pin count
+    // and prefix-sum their id bases.
+    std::vector<Chunk> chunks;
+    const uint64_t target = std::max<uint64_t>(1, pins / (threads * 8));
+    Chunk cur;
+    cur.mNetBase = ts.classCount();
+    uint64_t acc = 0;
+    for (uint32_t k = 0; k < perInst.size(); ++k) {
+        acc += perInst[k].mPins;
+        cur.mEnd = k + 1;
+        if (acc >= target || k + 1 == perInst.size()) {
+            chunks.push_back(cur);
+            Chunk next;
+            next.mBegin = next.mEnd = k + 1;
+            next.mInstBase = cur.mInstBase;
+            next.mPinBase = cur.mPinBase;
+            next.mNetBase = cur.mNetBase;
+            for (uint32_t j = cur.mBegin; j <= k; ++j) {
+                next.mInstBase += perInst[j].mLeaves;
+                next.mPinBase += perInst[j].mPins;
+                next.mNetBase += perInst[j].mNets;
+            }
+            cur = next;
+            acc = 0;
+        }
+    }
+
+    out.mInsts.resize(insts);
+    out.mInstPinBase.resize(insts + 1);
+    out.mInstPinBase[insts] = static_cast<uint32_t>(pins);
+    out.mPinInst.resize(pins);
+    std::vector<uint32_t> rawNet(pins);
+
+    // Top-level classes keep their own index as global id.
+    std::vector<uint32_t> topIds(ts.classCount());
+    for (uint32_t c = 0; c < topIds.size(); ++c)
+        topIds[c] = c;
+
+    auto runChunk = [&](const Chunk& ch) {
+        uint32_t instId = ch.mInstBase, pinId = ch.mPinBase;
+        uint32_t netId = ch.mNetBase;
+        std::vector<Frame> stack;
+        Frame root;
+        root.mSpec = &top;
+        root.mSummary = &ts;
+        root.mIds = topIds.data();
+        root.mNext = ch.mBegin;
+        root.mEnd = ch.mEnd;
+        stack.push_back(std::move(root));
+        std::vector<uint32_t> ids;
+        while (!stack.empty()) {
+            Frame& f = stack.back();
+            if (f.mNext == f.mEnd) {
+                // The top's own cells are emitted once, after all chunks.
+                if (stack.size() > 1)
+                    emitPrims(f, out, rawNet, instId, pinId, netId);
+                stack.pop_back();
+                continue;
+            }
+            const uint32_t instIndex = f.mNext++;
+            const InstanceSpec& inst = f.mSpec->mInstances[instIndex];
+            if (!inst.mCallee) continue;
+            const ModuleSpec& callee = *inst.mCallee;
+            const SpecNetSummary& cs = resolver.summary(callee);
+            enterInstance(f, inst, cs, netId, ids);
+            if (isLeaf(callee)) {
+                uint32_t nPins = portBitCount(callee);
+                out.mInsts[instId] = FlatLeaf{f.mSpec, instIndex, false};
+                out.mInstPinBase[instId] = pinId;
+                for (net::BitId b = 0; b < nPins; ++b, ++pinId) {
+                    out.mPinInst[pinId] = instId;
+                    rawNet[pinId] = ids[cs.mClassOf[callee.mBitMap.netOf(b)]];
+                }
+                ++instId;
+                continue;
+            }
+            Frame child;
+            child.mSpec = &callee;
+            child.mSummary = &cs;
+            child.mOwned = std::move(ids);
+            child.mIds = child.mOwned.data();
+            child.mEnd = static_cast<uint32_t>(callee.mInstances.size());
+            stack.push_back(std::move(child)); // invalidates f
+            ids = {};
+        }
+    };
+
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&] {
+        for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++)
+            runChunk(chunks[i]);
+    };
+    threads = std::min<unsigned>(threads, std::max<size_t>(1, chunks.size()));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+    {
+        Chunk tail;
+        for (const auto& ic : perInst) {
+            tail.mInstBase += ic.mLeaves;
+            tail.mPinBase += ic.mPins;
+            tail.mNetBase += ic.mNets;
+        }
+        Frame root;
+        root.mSpec = &top;
+        root.mSummary = &ts;
+        root.mIds = topIds.data();
+        uint32_t netId = ts.classCount() + tail.mNetBase;
+        emitPrims(
+          root, out, rawNet, tail.mInstBase, tail.mPinBase, netId);
+    }
+
+    // Keep only nets with pins, numbered by first pin, and index them.
+    std::vector<uint32_t> remap(nets, kNone);
+    uint32_t dense = 0;
+    out.mPinNet.resize(pins);
+    for (uint32_t p = 0; p < pins; ++p) {
+        uint32_t& r = remap[rawNet[p]];
+        if (r == kNone) r = dense++;
+        out.mPinNet[p] = r;
+    }
+    out.mNetPinOffsets.assign(static_cast<size_t>(dense) + 1, 0);
+    for (uint32_t p = 0; p < pins; ++p)
+        ++out.mNetPinOffsets[out.mPinNet[p] + 1];
+    for (uint32_t n = 0; n < dense; ++n)
+        out.mNetPinOffsets[n + 1] += out.mNetPinOffsets[n];
+    out.mNetPins.resize(pins);
+    std::vector<uint32_t> cursor(out.mNetPinOffsets.begin(),
+                                 out.mNetPinOffsets.end() - 1);
+    for (uint32_t p = 0; p < pins; ++p)
+        out.mNetPins[cursor[out.mPinNet[p]]++] = p;
+    return true;
+}
+
+} // namespace hdl::elab::hier
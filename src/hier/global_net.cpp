@@ -0,0 +1,127 @@
+#include "hdl/hier/global_net.hpp"
+
+#include "hdl/common.hpp"
+
+namespace hdl::elab::hier {
+
+net::BitId boundParentBit(const ModuleSpec& parent, const InstanceSpec& inst,
+                          net::BitId childBit) {
+    const InstanceTable& t = parent.mInstTable;
+    if (t.built()) return t.bit(&inst - parent.mInstances.data(), childBit);
+    net::BitOwnerRef port;
+    if (!inst.mCallee || !inst.mCallee->mBitMap.ownerOf(childBit, port))
+        return UINT32_MAX;
+    for (const auto& c : inst.mConns) {
+        if (c.mFormalIndex != port.mOwnerIndex) continue;
+        return parent.atomBit(c.mActual[port.mBitOffset]);
+    }
+    return UINT32_MAX;
+}
+
+const SpecNetSummary& GlobalNetResolver::summary(const ModuleSpec& spec) {
+    if (auto it = mSummaries.find(&spec); it != mSummaries.end())
+        return it->second;
+
+    const auto& bm = spec.mBitMap;
+    const net::NetId nets = bm.netCount();
+
+    // Union-find over local nets, merged through each child's classes.
+    net::Connectivity closure;
+    closure.allocRange(nets);
+    std::vector<net::NetId> firstNet;
+    const InstanceTable& it = spec.mInstTable;
+    std::vector<net::BitId> scratch;
+    for (uint32_t i = 0; i < it.size(); ++i) {
+        if (!it.callee(i)) continue;
+        const ModuleSpec& callee = *it.callee(i);
+        const SpecNetSummary& cs = summary(callee);
+        firstNet.assign(cs.classCount(), UINT32_MAX);
+        auto bound = it.bits(i).decode(scratch);
+        for (net::BitId cb = 0; cb < bound.size(); ++cb) {
+            if (bound[cb] == UINT32_MAX) continue;
+            net::NetId cc = cs.mClassOf[callee.mBitMap.netOf(cb)];
+            net::NetId pn = bm.netOf(bound[cb]);
+            if (firstNet[cc] == UINT32_MAX) firstNet[cc] = pn;
+            else closure.alias(firstNet[cc], pn);
+        }
+    }
+    closure.freeze();
+
+    SpecNetSummary s;
+    s.mClassOf.assign(closure.netOfArray().begin(), closure.netOfArray().end());
+    // Counting sort of port bits by class. Ports are allocated first, so
+    // port bits are [0, portBits) and stay ascending within a class.
+    net::BitId portBits = 0;
+    for (const auto& p : spec.mPorts)
+        portBits += p.width();
+    s.mExitOffsets.assign(static_cast<size_t>(closure.netCount()) + 1, 0);
+    for (net::BitId b = 0; b < portBits; ++b)
+        ++s.mExitOffsets[s.mClassOf[bm.netOf(b)] + 1];
+    for (size_t c = 1; c < s.mExitOffsets.size(); ++c)
+        s.mExitOffsets[c] += s.mExitOffsets[c - 1];
+    s.mExitBits.resize(portBits);
+    std::vector<uint32_t> cursor(s.mExitOffsets.begin(),
+                                 s.mExitOffsets.end() - 1);
+    for (net::BitId b = 0; b < portBits; ++b)
+        s.mExitBits[cursor[s.mClassOf[bm.netOf(b)]]++] = b;
+    return mSummaries.emplace(&spec, std::move(s)).first->second;
+}
+
+bool GlobalNetResolver::resolve(ScopeHandle scope, net::BitId bit,
+                                GlobalNetKey& out) {
+    if (scope == kInvalidScope || scope >= mScopes.size()) {
+        error(mDiag, "invalid scope handle");
+        return false;
+    }
+    if (bit >= mScopes.spec(scope).mBitMap.mConn.size()) {
+        error(mDiag, "bit " + std::to_string(bit) + " out of range");
+        return false;
+    }
+
+    net::NetId cls = 0;
+    while (true) {
+        const ModuleSpec& spec = mScopes.spec(scope);
+        const SpecNetSummary& s = summary(spec);
+        cls = s.mClassOf[spec.mBitMap.netOf(bit)];
+        if (scope == kRootScope || !s.hasExit(cls)) break;
+
+        // Leave through the first port bit the parent binds. The parent's
+        // closure already merged the actuals of all of them.
+        const ScopeHandle up = mScopes.parent(scope);
+        const ModuleSpec& parent = mScopes.spec(up);
+        const InstanceSpec& inst = *mScopes.instance(scope);
+        net::BitId pb = UINT32_MAX;
+        for (net::BitId exit : s.exits(cls)) {
+            pb = boundParentBit(parent, inst, exit);
+            if (pb != UINT32_MAX) break;
+        }
+        if (pb == UINT32_MAX) break; // unconnected: stops here
+        bit = pb;
+        scope = up;
+    }
+    out.mScope = scope;
+    out.mClass = cls;
+    return true;
+}
+
+bool GlobalNetResolver::resolvePort(ScopeHandle scope, IdString port,
+                                    uint32_t bitOff, GlobalNetKey& out) {
+    if (scope == kInvalidScope || scope >= mScopes.size()) {
+        error(mDiag, "invalid scope handle");
+        return false;
+    }
+    net::BitId b = mScopes.spec(scope).portBit(port, bitOff);
+    if (b == UINT32_MAX) {
+        error(mDiag, "no such port bit: " + port.str());
+        return false;
+    }
+    return resolve(scope, b, out);
+}
+
+bool GlobalNetResolver::sameNet(ScopeHandle a, net::BitId bitA, ScopeHandle b,
+                                net::BitId bitB) {
+    GlobalNetKey ka, kb;
+    return resolve(a, bitA, ka) && resolve(b, bitB, kb) && ka == kb;
+}
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,240 @@
+#include "hdl/hier/loops.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "hdl/common.hpp"
+#include "hdl/elab/flatten.hpp"
+#include "hdl/hier/port_model.hpp"
+
+namespace hdl::elab::hier {
+
+size_t loopWorkingSet(uint64_t bits, uint64_t edges) {
+    // offsets + rindex + component stack + DFS frames (node, cursor) +
+    // root bits, plus the adjacency itself.
+    return static_cast<size_t>(edges * 4 + bits * 21 + 8);
+}
+
+namespace {
+
+constexpr net::BitId kNone = UINT32_MAX;
+
+// Calls fn(from, to) for every edge; run once to count, once to fill.
+template <typename Fn>
+void forEachEdge(const ModuleSpec& spec, const PortModelCache& models,
+                 Fn&& fn) {
+    if (spec.mDecl) {
+        FlattenContext fc(spec, nullptr);
+        for (const auto& asg : spec.mDecl->mAssigns) {
+            BitVector L = fc.flattenExpr(asg.mLhs);
+            BitVector R = fc.flattenExpr(asg.mRhs);
+            if (L.size() != R.size()) continue;
+            for (size_t k = 0; k < L.size(); ++k) {
+                // Constants are sources; they cannot close a loop.
+                if (R[k].mKind == BitAtomKind::Const0 ||
+                    R[k].mKind == BitAtomKind::Const1)
+                    continue;
+                net::BitId l = spec.atomBit(L[k]);
+                net::BitId r = spec.atomBit(R[k]);
+                if (l != kNone && r != kNone) fn(r, l);
+            }
+        }
+    }
+    // Explicit cell arcs are combinational; arc-less cells are cut like
+    // opaque leaves.
+    const PrimTable& prims = spec.mPrims;
+    for (uint32_t i = 0; i < prims.size(); ++i) {
+        auto pins = prims.pins(i);
+        for (const CellArc& a : prims.type(i).mArcs)
+            if (pins[a.mFrom] != kNone && pins[a.mTo] != kNone)
+                fn(pins[a.mFrom], pins[a.mTo]);
+    }
+    const InstanceTable& it = spec.mInstTable;
+    std::vector<net::BitId> scratch;
+    for (uint32_t n = 0; n < it.size(); ++n) {
+        const PortModel* m = it.callee(n) ? models.find(*it.callee(n))
+                                          : nullptr;
+        if (!m || m->mFwd.empty()) continue;
+        auto bound = it.bits(n).decode(scratch);
+        for (net::BitId i = 0; i < m->mPortBits; ++i) {
+            if (bound[i] == kNone) continue;
+            for (const auto& r : m->reach(i, true))
+                for (net::BitId o = r.mLo; o < r.mHi; ++o)
+                    if (bound[o] != kNone) fn(bound[i], bound[o]);
+        }
+    }
+}
+
+// Pearce, "A space-efficient algorithm for finding strongly connected
+// components" (2016): one rindex word per node, which doubles as the
+// component id once a node is finished.
+void pearceScc(uint32_t n, const std::vector<uint32_t>& off,
+               const std::vector<uint32_t>& adj,
+               std::vector<std::vector<net::BitId>>& loops) {
+    std::vector<uint32_t> rindex(n, 0);
+    std::vector<bool> root(n, false);
+    std::vector<uint32_t> comp; // finished non-roots awaiting their root
+    std::vector<std::pair<uint32_t, uint32_t>> frames; // node, edge cursor
+    uint32_t index = 1;
+    uint32_t c = n - 1;
+    for (uint32_t s = 0; s < n; ++s) {
+        if (rindex[s]) continue;
+        rindex[s] = index++;
+        root[s] = true;
+        frames.emplace_back(s, off[s]);
+        while (!frames.empty()) {
+            auto& [v, e] = frames.back();
+            if (e < off[v + 1]) {
+                uint32_t w = adj[e++];
+                if (!rindex[w]) {
+                    rindex[w] = index++;
+                    root[w] = true;
+                    frames.emplace_back(w, off[w]);
+                } else if (rindex[w] < rindex[v]) {
+                    rindex[v] = rindex[w];
+                    root[v] = false;
+                }
+                continue;
+            }
+            uint32_t done = v;
+            frames.pop_back();
+            if (root[done]) {
+                --index;
+                std::vector<net::BitId> members{done};
+                while (!comp.empty() && rindex[done] <= rindex[comp.back()]) {
+                    uint32_t w = comp.back();
+                    comp.pop_back();
+                    rindex[w] = c;
+                    --index;
+                    members.push_back(w);
+                }
+                rindex[done] = c--;
+                bool self = false;
+                if (members.size() == 1)
+                    for (uint32_t k = off[done]; k < off[done + 1]; ++k)
+                        self |= adj[k] == done;
+                if (members.size() > 1 || self) {
+                    std::sort(members.begin(), members.end());
+                    loops.push_back(std::move(members));
+                }
+            } else {
+                comp.push_back(done);
+            }
+            if (!frames.empty()) {
+                uint32_t u = frames.back().first;
+                if (rindex[done] < rindex[u]) {
+                    rindex[u] = rindex[done];
+                    root[u] = false;
+                }
+            }
+        }
+    }
+    std::sort(loops.begin(), loops.end());
+}
+
+// Bytes reserved by running modules; waits while a module would overrun.
+class Budget {
+  public:
+    explicit Budget(size_t cap)
+        : mCap(cap) {}
+    bool acquire(size_t bytes) {
+        if (bytes > mCap) return false;
+        std::unique_lock lk(mMu);
+        mCv.wait(lk, [&] { return mUsed + bytes <= mCap; });
+        mUsed += bytes;
+        return true;
+    }
+    void release(size_t bytes) {
+        {
+            std::lock_guard lk(mMu);
+            mUsed -= bytes;
+        }
+        mCv.notify_all();
+    }
+
+  private:
+    size_t mCap;
+    size_t mUsed = 0;
+    std::mutex mMu;
+    std::condition_variable mCv;
+};
+
+void analyze(const ModuleSpec& spec, const PortModelCache& models,
+             Budget& budget, ModuleLoops& out) {
+    const uint32_t n = spec.mBitMap.mConn.size();
+    std::vector<uint32_t> off(static_cast<size_t>(n) + 1, 0);
+    uint64_t edges = 0;
+    forEachEdge(spec, models, [&](net::BitId a, net::BitId) {
+        ++off[a + 1];
+        ++edges;
+    });
+    out.mEdges = edges;
+    if (edges == 0) return;
+    // Counting needs the offsets up front; they are part of the estimate.
+    size_t bytes = loopWorkingSet(n, edges);
+    if (!budget.acquire(bytes)) {
+        out.mSkipped = true;
+        return;
+    }
+    for (uint32_t b = 0; b < n; ++b)
+        off[b + 1] += off[b];
+    std::vector<uint32_t> adj(edges);
+    {
+        std::vector<uint32_t> cur(off.begin(), off.end() - 1);
+        forEachEdge(spec, models, [&](net::BitId a, net::BitId b) {
+            adj[cur[a]++] = b;
+        });
+    }
+    pearceScc(n, off, adj, out.mLoops);
+    budget.release(bytes);
+}
+
+} // namespace
+
+bool findCombLoops(std::span<const ModuleSpec* const> specs,
+                   const LoopOptions& opts, std::vector<ModuleLoops>& out,
+                   std::ostream* diag) {
+    out.assign(specs.size(), ModuleLoops{});
+    // Models are memoized lazily, so compute them all before going wide.
+    PortModelCache models(/*cutOpaque=*/true);
+    for (size_t i = 0; i < specs.size(); ++i) {
+        out[i].mSpec = specs[i];
+        for (const auto& inst : specs[i]->mInstances)
+            if (inst.mCallee) models.model(*inst.mCallee);
+    }
+
+    Budget budget(opts.mMemoryBudget);
+    unsigned t = opts.mThreads ? opts.mThreads
+                               : std::thread::hardware_concurrency();
+    t = static_cast<unsigned>(
+      std::clamp<size_t>(t, 1, std::max<size_t>(1, specs.size())));
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < specs.size();)
+            analyze(*specs[i], models, budget, out[i]);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < t; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    bool ok = true;
+    for (const auto& m : out) {
+        if (!m.mSkipped) continue;
+        ok = false;
+        error(diag,
+              "loop check of " + m.mSpec->mName.str() + " needs " +
+                std::to_string(loopWorkingSet(m.mSpec->mBitMap.mConn.size(),
+                                              m.mEdges)) +
+                " bytes, over the " + std::to_string(opts.mMemoryBudget) +
+                " byte budget");
+    }
+    return ok;
+}
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,157 @@
+#include "hdl/hier/path.hpp"
+
+#include <charconv>
+#include <vector>
+
+#include "hdl/common.hpp"
+
+namespace hdl::elab::hier {
+
+namespace {
+
+// Declared index -> LSB-first offset, as in FlattenContext.
+bool offsetOf(const NetSpec& net, int64_t idx, uint32_t& off) {
+    int64_t o = net.mMsb >= net.mLsb ? idx - net.mLsb : net.mLsb - idx;
+    if (o < 0 || o >= net.width()) return false;
+    off = static_cast<uint32_t>(o);
+    return true;
+}
+
+int64_t indexOf(const NetSpec& net, uint32_t off) {
+    return net.mMsb >= net.mLsb ? int64_t(net.mLsb) + off
+                                : int64_t(net.mLsb) - off;
+}
+
+} // namespace
+
+ScopeHandle PathResolver::resolveScope(std::string_view path) {
+    while (!path.empty() && path.back() == '/')
+        path.remove_suffix(1);
+    if (path.empty()) return kRootScope;
+    if (auto it = mCache.find(std::string(path)); it != mCache.end())
+        return it->second;
+
+    // Longest memoized prefix, probing at each '/' from the right.
+    ScopeHandle h = kRootScope;
+    size_t pos = 0;
+    for (size_t cut = path.rfind('/'); cut != std::string_view::npos;
+         cut = cut ? path.rfind('/', cut - 1) : std::string_view::npos) {
+        if (auto it = mCache.find(std::string(path.substr(0, cut)));
+            it != mCache.end()) {
+            h = it->second;
+            pos = cut + 1;
+            break;
+        }
+    }
+
+    while (pos <= path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == std::string_view::npos) end = path.size();
+        std::string_view seg = path.substr(pos, end - pos);
+        const ModuleSpec& spec = mScopes.spec(h);
+        IdString name = IdString::tryLookup(seg);
+        int idx = name.valid() ? spec.findInstanceIndex(name) : -1;
+        if (idx < 0 && pos == 0 && h == kRootScope &&
+            seg == spec.mName.str()) {
+            // Leading top-module name.
+        } else if (idx < 0) {
+            error(mDiag,
+                  "no instance '" + std::string(seg) + "' in module " +
+                    spec.mName.str());
+            return kInvalidScope;
+        } else {
+            h = mScopes.child(h, static_cast<uint32_t>(idx));
+            if (h == kInvalidScope) {
+                error(mDiag, "instance '" + std::string(seg) + "' is unlinked");
+                return kInvalidScope;
+            }
+        }
+        mCache.emplace(std::string(path.substr(0, end)), h);
+        pos = end + 1;
+    }
+    return h;
+}
+
+bool PathResolver::resolvePin(std::string_view path, HierPinRef& out) {
+    size_t slash = path.rfind('/');
+    size_t dot = path.find('.', slash == std::string_view::npos ? 0 : slash);
+    std::string_view scopePart, pinPart;
+    if (dot == std::string_view::npos) {
+        // Bare port on the top module.
+        if (slash != std::string_view::npos) {
+            error(mDiag, "missing '.port' in " + std::string(path));
+            return false;
+        }
+        pinPart = path;
+    } else {
+        scopePart = path.substr(0, dot);
+        pinPart = path.substr(dot + 1);
+    }
+
+    std::string_view portName = pinPart;
+    bool whole = true;
+    int64_t index = 0;
+    if (size_t lb = pinPart.find('['); lb != std::string_view::npos) {
+        if (pinPart.back() != ']') {
+            error(mDiag, "malformed bit select in " + std::string(path));
+            return false;
+        }
+        std::string_view num = pinPart.substr(lb + 1, pinPart.size() - lb - 2);
+        auto [p, ec] = std::from_chars(num.data(), num.data() + num.size(),
+                                       index);
+        if (ec != std::errc{} || p != num.data() + num.size()) {
+            error(mDiag, "malformed bit select in " + std::string(path));
+            return false;
+        }
+        portName = pinPart.substr(0, lb);
+        whole = false;
+    }
+
+    ScopeHandle h = resolveScope(scopePart);
+    if (h == kInvalidScope) return false;
+    const ModuleSpec& spec = mScopes.spec(h);
+    IdString pname = IdString::tryLookup(portName);
+    int pIdx = pname.valid() ? spec.findPortIndex(pname) : -1;
+    if (pIdx < 0) {
+        error(mDiag,
+              "no port '" + std::string(portName) + "' in module " +
+                spec.mName.str());
+        return false;
+    }
+    uint32_t off = 0;
+    if (!whole && !offsetOf(spec.mPorts[pIdx].mNet, index, off)) {
+        error(mDiag,
+              "bit " + std::to_string(index) + " out of range for port " +
+                std::string(portName));
+        return false;
+    }
+    out.mPin.mScope = h;
+    out.mPin.mPortIndex = static_cast<uint32_t>(pIdx);
+    out.mBitOff = off;
+    out.mWholePort = whole;
+    return true;
+}
+
+std::string PathResolver::scopePath(ScopeHandle h) const {
+    std::vector<const InstanceSpec*> chain;
+    for (; h != kRootScope; h = mScopes.parent(h))
+        chain.push_back(mScopes.instance(h));
+    std::string s;
+    for (size_t i = chain.size(); i-- > 0;) {
+        s += chain[i]->mName.str();
+        if (i) s.push_back('/');
+    }
+    return s;
+}
+
+std::string PathResolver::pinPath(const HierPinRef& pin) const {
+    const PortSpec& p = mScopes.spec(pin.mPin.mScope).mPorts[pin.mPin.mPortIndex];
+    std::string s = scopePath(pin.mPin.mScope);
+    if (!s.empty()) s.push_back('.');
+    s += p.mName.str();
+    if (!pin.mWholePort)
+        s += "[" + std::to_string(indexOf(p.mNet, pin.mBitOff)) + "]";
+    return s;
+}
+
+} // namespace hdl::elab::hier
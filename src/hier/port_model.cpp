@@ -0,0 +1,219 @@
+#include "hdl/hier/port_model.hpp"
+
+#include <algorithm>
+
+#include "hdl/hier/cone.hpp"
+#include "hdl/hier/global_net.hpp"
+
+namespace hdl::elab::hier {
+
+size_t PortModel::arcCount() const {
+    size_t n = 0;
+    for (const auto& r : mFwd)
+        n += r.mHi - r.mLo;
+    return n;
+}
+
+size_t PortModel::memoryBytes() const {
+    return (mFwdOffsets.capacity() + mRevOffsets.capacity()) *
+             sizeof(uint32_t) +
+           (mFwd.capacity() + mRev.capacity()) * sizeof(BitRange);
+}
+
+namespace {
+
+constexpr net::BitId kNone = UINT32_MAX;
+
+bool isSource(PortDirection d) { return d != PortDirection::Out; }
+bool isSink(PortDirection d) { return d != PortDirection::In; }
+
+// Sorted, de-duplicated bits -> ranges appended to out.
+void appendRanges(std::vector<net::BitId>& bits, std::vector<BitRange>& out) {
+    std::sort(bits.begin(), bits.end());
+    bits.erase(std::unique(bits.begin(), bits.end()), bits.end());
+    for (size_t i = 0; i < bits.size();) {
+        size_t j = i + 1;
+        while (j < bits.size() && bits[j] == bits[j - 1] + 1)
+            ++j;
+        out.push_back(BitRange{bits[i], bits[j - 1] + 1});
+        i = j;
+    }
+}
+
+// Ranges of port bits whose port direction passes `pred`.
+template <typename Pred>
+std::vector<BitRange> portRanges(const ModuleSpec& spec, Pred pred) {
+    std::vector<BitRange> r;
+    for (uint32_t p = 0; p < spec.mPorts.size(); ++p) {
+        if (!pred(spec.mPorts[p].mDir) || spec.mPorts[p].width() == 0)
+            continue;
+        net::BitId lo = spec.mBitMap.portBit(p, 0);
+        net::BitId hi = lo + spec.mPorts[p].width();
+        if (!r.empty() && r.back().mHi == lo) r.back().mHi = hi;
+        else r.push_back(BitRange{lo, hi});
+    }
+    return r;
+}
+
+// Builds the reverse CSR by transposing the forward ranges.
+void buildReverse(PortModel& m) {
+    std::vector<std::vector<net::BitId>> rev(m.mPortBits);
+    for (net::BitId i = 0; i < m.mPortBits; ++i)
+        for (const auto& r : m.reach(i, true))
+            for (net::BitId o = r.mLo; o < r.mHi; ++o)
+                rev[o].push_back(i);
+    m.mRevOffsets.assign(1, 0);
+    for (auto& v : rev) {
+        appendRanges(v, m.mRev);
+        m.mRevOffsets.push_back(static_cast<uint32_t>(m.mRev.size()));
+    }
+}
+
+} // namespace
+
+const PortModel& PortModelCache::model(const ModuleSpec& spec) {
+    if (auto it = mModels.find(&spec); it != mModels.end())
+        return it->second;
+
+    PortModel m;
+    for (const auto& p : spec.mPorts)
+        m.mPortBits += p.width();
+
+    if (isOpaqueLeaf(spec) && mCutOpaque) {
+        m.mFwdOffsets.assign(m.mPortBits + 1, 0);
+        m.mRevOffsets.assign(m.mPortBits + 1, 0);
+        return mModels.emplace(&spec, std::move(m)).first->second;
+    }
+    if (isOpaqueLeaf(spec)) {
+        m.mFull = true;
+        auto outs = portRanges(spec, isSink);
+        auto ins = portRanges(spec, isSource);
+        auto fill = [&](std::vector<uint32_t>& off, std::vector<BitRange>& r,
+                        bool (*from)(PortDirection),
+                        const std::vector<BitRange>& to) {
+            off.assign(1, 0);
+            for (uint32_t p = 0; p < spec.mPorts.size(); ++p) {
+                for (uint32_t k = 0; k < spec.mPorts[p].width(); ++k) {
+                    if (from(spec.mPorts[p].mDir))
+                        r.insert(r.end(), to.begin(), to.end());
+                    off.push_back(static_cast<uint32_t>(r.size()));
+                }
+            }
+        };
+        fill(m.mFwdOffsets, m.mFwd, isSource, outs);
+        fill(m.mRevOffsets, m.mRev, isSink, ins);
+        return mModels.emplace(&spec, std::move(m)).first->second;
+    }
+
+    // Directed graph over local nets, plus one hub node per instance with
+    // a full model so an n-in/m-out leaf costs n + m edges, not n * m.
+    const auto& bm = spec.mBitMap;
+    const uint32_t nets = bm.netCount();
+    uint32_t nodes = nets;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (const auto& inst : spec.mInstances) {
+        if (!inst.mCallee) continue;
+        const ModuleSpec& callee = *inst.mCallee;
+        const PortModel& cm = model(callee);
+        std::vector<net::BitId> parentBit(cm.mPortBits, kNone);
+        for (net::BitId b = 0; b < cm.mPortBits; ++b)
+            parentBit[b] = boundParentBit(spec, inst, b);
+        if (cm.mFull) {
+            uint32_t hub = nodes++;
+            for (uint32_t p = 0; p < callee.mPorts.size(); ++p) {
+                PortDirection d = callee.mPorts[p].mDir;
+                for (uint32_t k = 0; k < callee.mPorts[p].width(); ++k) {
+                    net::BitId pb = parentBit[callee.mBitMap.portBit(p, k)];
+                    if (pb == kNone) continue;
+                    if (isSource(d)) edges.emplace_back(bm.netOf(pb), hub);
+                    if (isSink(d)) edges.emplace_back(hub, bm.netOf(pb));
+                }
+            }
+            continue;
+        }
+        for (net::BitId i = 0; i < cm.mPortBits; ++i) {
+            if (parentBit[i] == kNone) continue;
+            for (const auto& r : cm.reach(i, true)) {
+                for (net::BitId o = r.mLo; o < r.mHi; ++o) {
+                    if (parentBit[o] == kNone) continue;
+                    edges.emplace_back(bm.netOf(parentBit[i]),
+                                       bm.netOf(parentBit[o]));
+                }
+            }
+        }
+    }
+    // Primitive cells: explicit arcs are edges. Arc-less cells are opaque
+    // logic, cut with the opaque leaves and otherwise one hub.
+    const PrimTable& prims = spec.mPrims;
+    for (uint32_t i = 0; i < prims.size(); ++i) {
+        const CellType& ct = prims.type(i);
+        auto pins = prims.pins(i);
+        if (!ct.opaque()) {
+            for (const CellArc& a : ct.mArcs)
+                if (pins[a.mFrom] != kNone && pins[a.mTo] != kNone)
+                    edges.emplace_back(bm.netOf(pins[a.mFrom]),
+                                       bm.netOf(pins[a.mTo]));
+            continue;
+        }
+        if (mCutOpaque) continue;
+        uint32_t hub = nodes++;
+        for (uint32_t p = 0; p < pins.size(); ++p) {
+            if (pins[p] == kNone) continue;
+            if (isSource(ct.mPins[p].mDir))
+                edges.emplace_back(bm.netOf(pins[p]), hub);
+            if (isSink(ct.mPins[p].mDir))
+                edges.emplace_back(hub, bm.netOf(pins[p]));
+        }
+    }
+    std::vector<uint32_t> adjOff(static_cast<size_t>(nodes) + 1, 0);
+    for (const auto& e : edges)
+        ++adjOff[e.first + 1];
+    for (size_t n = 1; n < adjOff.size(); ++n)
+        adjOff[n] += adjOff[n - 1];
+    std::vector<uint32_t> adj(edges.size());
+    {
+        std::vector<uint32_t> cur(adjOff.begin(), adjOff.end() - 1);
+        for (const auto& e : edges)
+            adj[cur[e.first]++] = e.second;
+    }
+
+    // One BFS per source port bit; stamps avoid clearing between runs.
+    std::vector<uint32_t> stamp(nodes, kNone);
+    std::vector<uint32_t> queue;
+    std::vector<net::BitId> hit;
+    m.mFwdOffsets.assign(1, 0);
+    for (uint32_t p = 0; p < spec.mPorts.size(); ++p) {
+        for (uint32_t k = 0; k < spec.mPorts[p].width(); ++k) {
+            net::BitId src = bm.portBit(p, k);
+            if (isSource(spec.mPorts[p].mDir)) {
+                queue.assign(1, bm.netOf(src));
+                stamp[queue[0]] = src;
+                hit.clear();
+                for (size_t q = 0; q < queue.size(); ++q) {
+                    uint32_t n = queue[q];
+                    if (n < nets) {
+                        // Port bits come first within a net.
+                        for (net::BitId b : bm.netGroups()[n]) {
+                            if (b >= m.mPortBits) break;
+                            net::BitOwnerRef o;
+                            if (b != src && bm.ownerOf(b, o) &&
+                                isSink(spec.mPorts[o.mOwnerIndex].mDir))
+                                hit.push_back(b);
+                        }
+                    }
+                    for (uint32_t e = adjOff[n]; e < adjOff[n + 1]; ++e) {
+                        if (stamp[adj[e]] == src) continue;
+                        stamp[adj[e]] = src;
+                        queue.push_back(adj[e]);
+                    }
+                }
+                appendRanges(hit, m.mFwd);
+            }
+            m.mFwdOffsets.push_back(static_cast<uint32_t>(m.mFwd.size()));
+        }
+    }
+    buildReverse(m);
+    return mModels.emplace(&spec, std::move(m)).first->second;
+}
+
+} // namespace hdl::elab::hier
@@ -0,0 +1,69 @@
+#include "hdl/hier/rollup.hpp"
+
+#include <algorithm>
+
+#include "hdl/common.hpp"
+
+namespace hdl::elab::hier {
+
+RollupTable::RollupTable(const ModuleSpec& top, std::ostream* diag) {
+    // Iterative post-order DFS over unique specs.
+    enum class Mark : uint8_t { Open, Done };
+    std::unordered_map<const ModuleSpec*, Mark> mark;
+    std::vector<std::pair<const ModuleSpec*, size_t>> stack;
+    mark.emplace(&top, Mark::Open);
+    stack.emplace_back(&top, 0);
+    while (!stack.empty()) {
+        auto& [spec, next] = stack.back();
+        if (next == spec->mInstances.size()) {
+            mark[spec] = Mark::Done;
+            mOrder.push_back(spec);
+            stack.pop_back();
+            continue;
+        }
+        const InstanceSpec& inst = spec->mInstances[next++];
+        if (!inst.mCallee) continue;
+        auto [it, fresh] = mark.emplace(inst.mCallee, Mark::Open);
+        if (fresh) {
+            stack.emplace_back(inst.mCallee, 0);
+        } else if (it->second == Mark::Open) {
+            error(diag,
+                  "instance cycle through " + inst.mName.str() + " in " +
+                    spec->mName.str());
+        }
+    }
+
+    mRollups.reserve(mOrder.size());
+    for (const ModuleSpec* spec : mOrder) {
+        SpecRollup r;
+        r.mBits = spec->mBitMap.mConn.size();
+        r.mNets = spec->mBitMap.netCount();
+        const PrimTable& prims = spec->mPrims;
+        r.mInstances += prims.size();
+        r.mLeafInstances += prims.size();
+        r.mLeafPins += prims.mPinBits.size();
+        for (const auto& inst : spec->mInstances) {
+            // Callees come earlier in mOrder unless this is a cycle edge.
+            auto it = inst.mCallee ? mRollups.find(inst.mCallee)
+                                   : mRollups.end();
+            if (it == mRollups.end()) continue;
+            const SpecRollup& c = it->second;
+            r.mInstances += 1 + c.mInstances;
+            if (inst.mCallee->mInstances.empty() &&
+                inst.mCallee->mPrims.empty()) {
+                r.mLeafInstances += 1;
+                for (const auto& p : inst.mCallee->mPorts)
+                    r.mLeafPins += p.width();
+            } else {
+                r.mLeafInstances += c.mLeafInstances;
+                r.mLeafPins += c.mLeafPins;
+            }
+            r.mBits += c.mBits;
+            r.mNets += c.mNets;
+            r.mDepth = std::max(r.mDepth, c.mDepth + 1);
+        }
+        mRollups.emplace(spec, r);
+    }
+}
+
+} // namespace hdl::elab::hier
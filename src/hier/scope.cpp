@@ -0,0 +1,46 @@
+#include "hdl/hier/scope.hpp"
+
+#include "hdl/common.hpp"
+
+namespace hdl::elab::hier {
+
+ScopeHandle ScopeTable::child(ScopeHandle parent, uint32_t instIndex) {
+    uint64_t key = (static_cast<uint64_t>(parent) << 32) | instIndex;
+    if (auto it = mChildren.find(key); it != mChildren.end())
+        return it->second;
+    const ModuleSpec& ps = *mEntries[parent].mSpec;
+    if (instIndex >= ps.mInstances.size() ||
+        !ps.mInstances[instIndex].mCallee)
+        return kInvalidScope;
+    auto h = static_cast<ScopeHandle>(mEntries.size());
+    mEntries.push_back(Entry{parent,
+                             instIndex,
+                             mEntries[parent].mDepth + 1,
+                             ps.mInstances[instIndex].mCallee});
+    mChildren.emplace(key, h);
+    return h;
+}
+
+ScopeHandle ScopeTable::intern(const ScopeId& path, std::ostream* diag) {
+    ScopeHandle h = kRootScope;
+    for (size_t depth = 0; depth < path.mPath.size(); ++depth) {
+        h = child(h, path.mPath[depth]);
+        if (h == kInvalidScope) {
+            error(diag,
+                  "bad scope path index " + std::to_string(path.mPath[depth]) +
+                    " at depth " + std::to_string(depth));
+            return kInvalidScope;
+        }
+    }
+    return h;
+}
+
+ScopeId ScopeTable::path(ScopeHandle h) const {
+    ScopeId s;
+    s.mPath.resize(mEntries[h].mDepth);
+    for (size_t i = s.mPath.size(); i-- > 0; h = mEntries[h].mParent)
+        s.mPath[i] = mEntries[h].mInstIndex;
+    return s;
+}
+
+} // namespace hdl::elab::hier
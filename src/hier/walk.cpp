@@ -0,0 +1,51 @@
+#include "hdl/hier/walk.hpp"
+
+#include <algorithm>
+
+namespace hdl::elab::hier {
+
+Generator<InstanceVisit> walkInstances(ScopeTable& scopes, ScopeHandle from,
+                                       WalkOptions opts) {
+    struct Frame {
+        const ModuleSpec* mSpec;
+        ScopeHandle mScope;
+        uint32_t mNext;
+    };
+    auto pruned = [&](const InstanceVisit& v) {
+        const IdString& callee = v.mInst->mCallee->mName;
+        if (std::find(opts.mPruneModules.begin(),
+                      opts.mPruneModules.end(),
+                      callee) != opts.mPruneModules.end())
+            return true;
+        return opts.mPrune && opts.mPrune(v);
+    };
+
+    if (opts.mMaxDepth == 0) co_return;
+    std::vector<Frame> stack{{&scopes.spec(from), from, 0}};
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        if (f.mNext == f.mSpec->mInstances.size()) {
+            stack.pop_back();
+            continue;
+        }
+        const uint32_t idx = f.mNext++;
+        const InstanceSpec& inst = f.mSpec->mInstances[idx];
+        if (!inst.mCallee) continue;
+
+        InstanceVisit v;
+        v.mParent = f.mScope;
+        v.mInst = &inst;
+        v.mIndex = idx;
+        v.mDepth = static_cast<uint32_t>(stack.size());
+        if (opts.mInternScopes && f.mScope != kInvalidScope)
+            v.mScope = scopes.child(f.mScope, idx);
+        // Decide before yielding: the consumer may touch the table.
+        bool descend = v.mDepth < opts.mMaxDepth &&
+                       !inst.mCallee->mInstances.empty() && !pruned(v);
+        const ModuleSpec* callee = inst.mCallee;
+        co_yield v;
+        if (descend) stack.push_back(Frame{callee, v.mScope, 0});
+    }
+}
+
+} // namespace hdl::elab::hier
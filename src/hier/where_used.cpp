@@ -0,0 +1,114 @@
+#include "hdl/hier/where_used.hpp"
+
+namespace hdl::elab::hier {
+
+std::vector<SpecUse> whereUsed(std::span<const ModuleSpec* const> specs) {
+    size_t n = 0;
+    for (const ModuleSpec* s : specs)
+        n += s->mUsers.size();
+    std::vector<SpecUse> out;
+    out.reserve(n);
+    for (const ModuleSpec* s : specs)
+        out.insert(out.end(), s->mUsers.begin(), s->mUsers.end());
+    return out;
+}
+
+RootPaths::RootPaths(const ModuleSpec& top, const ModuleSpec& target)
+    : mTop(top)
+    , mTarget(target) {}
+
+// Memoized upward DFS: 1 = reaches the top, 0 = does not, -1 = on stack
+// (a cycle, treated as unreachable).
+bool RootPaths::reachesTop(const ModuleSpec* s) const {
+    if (s == &mTop) return true;
+    if (auto it = mReach.find(s); it != mReach.end()) return it->second > 0;
+    std::vector<std::pair<const ModuleSpec*, size_t>> stack{{s, 0}};
+    mReach[s] = -1;
+    while (!stack.empty()) {
+        auto& [cur, next] = stack.back();
+        if (mReach[cur] == 1 || next == cur->mUsers.size()) {
+            if (mReach[cur] != 1) mReach[cur] = 0;
+            bool r = mReach[cur] == 1;
+            stack.pop_back();
+            if (r && !stack.empty()) mReach[stack.back().first] = 1;
+            continue;
+        }
+        const ModuleSpec* p = cur->mUsers[next++].mParent;
+        if (p == &mTop) {
+            mReach[cur] = 1;
+            continue;
+        }
+        auto [it, fresh] = mReach.emplace(p, -1);
+        if (fresh) stack.emplace_back(p, 0);
+        else if (it->second == 1) mReach[cur] = 1;
+    }
+    return mReach[s] == 1;
+}
+
+uint64_t RootPaths::count() const {
+    if (!reachesTop(&mTarget)) return 0;
+    // Paths(s) = sum over users whose parent reaches the top, in an
+    // upward post-order.
+    std::unordered_map<const ModuleSpec*, uint64_t> memo{{&mTop, 1}};
+    std::vector<std::pair<const ModuleSpec*, size_t>> stack{{&mTarget, 0}};
+    while (!stack.empty()) {
+        auto& [cur, next] = stack.back();
+        if (next == cur->mUsers.size()) {
+            uint64_t sum = 0;
+            for (const auto& u : cur->mUsers) {
+                auto it = memo.find(u.mParent);
+                if (it == memo.end()) continue;
+                sum = UINT64_MAX - sum < it->second ? UINT64_MAX
+                                                    : sum + it->second;
+            }
+            memo[cur] = sum;
+            stack.pop_back();
+            continue;
+        }
+        const ModuleSpec* p = cur->mUsers[next++].mParent;
+        if (!memo.count(p) && reachesTop(p)) stack.emplace_back(p, 0);
+    }
+    return memo[&mTarget];
+}
+
+size_t RootPaths::forEach(
+  const std::function<bool(const ScopeId&)>& fn) const {
+    if (!reachesTop(&mTarget)) return 0;
+    if (&mTarget == &mTop) {
+        fn(ScopeId{});
+        return 1;
+    }
+
+    // Upward DFS; the stack holds (spec, next user) and mirrors the
+    // bottom-up instance index chain in `rev`.
+    struct Frame {
+        const ModuleSpec* mSpec;
+        size_t mNext;
+    };
+    std::vector<Frame> stack{{&mTarget, 0}};
+    std::vector<uint32_t> rev;
+    ScopeId path;
+    size_t emitted = 0;
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        if (f.mNext == f.mSpec->mUsers.size()) {
+            stack.pop_back();
+            if (!rev.empty()) rev.pop_back();
+            continue;
+        }
+        const SpecUse& u = f.mSpec->mUsers[f.mNext++];
+        if (!reachesTop(u.mParent)) continue;
+        rev.push_back(u.mInstIndex);
+        if (u.mParent == &mTop) {
+            path.mPath.assign(rev.rbegin(), rev.rend());
+            ++emitted;
+            if (!fn(path)) return emitted;
+            rev.pop_back();
+            continue;
+        }
+        stack.push_back(Frame{u.mParent, 0});
+    }
+    return emitted;
+}
+
+} // namespace hdl::elab::hier
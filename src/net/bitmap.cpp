@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "hdl/net/bitmap.hpp"
 #include "hdl/elab/spec.hpp"
 #include "hdl/util/id_string.hpp"
@@ -8,47 +10,63 @@ void BitMap::build(const elab::ModuleSpec& spec) {
     reset();
     mPortBase.resize(spec.mPorts.size(), 0);
     mWireBase.resize(spec.mWires.size(), 0);
+    mOwnerRanges.reserve(spec.mPorts.size() + spec.mWires.size() + 2);
 
     // Allocate ports
     for (size_t i = 0; i < spec.mPorts.size(); ++i) {
         auto w = spec.mPorts[i].width();
         BitId base = mConn.allocRange(w);
         mPortBase[i] = base;
+        mOwnerRanges.push_back(BitOwnerRange{
+          base, BitOwnerRef::Kind::Port, static_cast<uint32_t>(i)});
     }
     // Allocate wires
     for (size_t i = 0; i < spec.mWires.size(); ++i) {
         auto w = spec.mWires[i].width();
         BitId base = mConn.allocRange(w);
         mWireBase[i] = base;
+        mOwnerRanges.push_back(BitOwnerRange{
+          base, BitOwnerRef::Kind::Wire, static_cast<uint32_t>(i)});
     }
+    // Tie-offs
+    mTieBase = mConn.allocRange(2);
+    mOwnerRanges.push_back(
+      BitOwnerRange{mTieBase, BitOwnerRef::Kind::Tie, 0});
+    mOwnerRanges.push_back(
+      BitOwnerRange{mTieBase + 1, BitOwnerRef::Kind::Tie, 1});
+}
 
-    // Build reverse map
-    mReverseMap.resize(mConn.size());
-    for (size_t i = 0; i < spec.mPorts.size(); ++i) {
-        for (uint32_t b = 0; b < spec.mPorts[i].width(); ++b) {
-            mReverseMap[mPortBase[i] + b] = BitOwnerRef{
-              BitOwnerRef::Kind::Port, static_cast<uint32_t>(i), b};
-        }
-    }
-    for (size_t i = 0; i < spec.mWires.size(); ++i) {
-        for (uint32_t b = 0; b < spec.mWires[i].width(); ++b) {
-            mReverseMap[mWireBase[i] + b] = BitOwnerRef{
-              BitOwnerRef::Kind::Wire, static_cast<uint32_t>(i), b};
-        }
-    }
+bool BitMap::ownerOf(BitId g, BitOwnerRef& out) const {
+    if (g >= mConn.size() || mOwnerRanges.empty()) return false;
+    auto it = std::upper_bound(
+      mOwnerRanges.begin(),
+      mOwnerRanges.end(),
+      g,
+      [](BitId v, const BitOwnerRange& r) { return v < r.mBase; });
+    const auto& r = *(it - 1); // ranges start at 0, so it > begin()
+    out = BitOwnerRef{r.mKind, r.mOwnerIndex, g - r.mBase};
+    return true;
+}
+
+size_t BitMap::memoryBytes() const {
+    return sizeof(BitMap) + mConn.memoryBytes() +
+           (mPortBase.capacity() + mWireBase.capacity()) * sizeof(BitId) +
+           mOwnerRanges.capacity() * sizeof(BitOwnerRange);
 }
 
 std::string BitMap::renderBit(const elab::ModuleSpec& spec, BitId g) const {
-    if (g >= mReverseMap.size()) {
+    BitOwnerRef r;
+    if (!ownerOf(g, r)) {
         return "<out-of-range:" + std::to_string(g) + ">";
     }
-    const auto& r = mReverseMap[g];
     if (r.mKind == BitOwnerRef::Kind::Port) {
         const auto& p = spec.mPorts[r.mOwnerIndex];
         int idx = (p.mNet.mMsb >= p.mNet.mLsb)
                     ? (p.mNet.mLsb + static_cast<int>(r.mBitOffset))
                     : (p.mNet.mLsb - static_cast<int>(r.mBitOffset));
         return "port " + p.mName.str() + "[" + std::to_string(idx) + "]";
+    } else if (r.mKind == BitOwnerRef::Kind::Tie) {
+        return r.mOwnerIndex ? "1'b1" : "1'b0";
     } else {
         const auto& w = spec.mWires[r.mOwnerIndex];
         int idx = (w.mNet.mMsb >= w.mNet.mLsb)
@@ -58,4 +76,4 @@ std::string BitMap::renderBit(const elab::ModuleSpec& spec, BitId g) const {
     }
 }
 
-} // namespace hdl::net
\ No newline at end of file
+} // namespace hdl::net
@@ -1,75 +1,321 @@
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
 #include "hdl/net/connectivity.hpp"
 
 namespace hdl::net {
+const char* to_string(UnionFindMode m) {
+    switch (m) {
+    case UnionFindMode::Sequential: return "sequential";
+    case UnionFindMode::Concurrent: return "concurrent";
+    }
+    return "?";
+}
+
 // -------------------------------------------
 // UnionFindBits
-BitId UnionFindBits::addNode() {
-    BitId idx = static_cast<BitId>(mParent.size());
-    mParent.push_back(idx);
-    mRank.push_back(0);
-    return idx;
-}
+BitId UnionFindBits::addNode() { return mSize++; }
 
 void UnionFindBits::ensureSize(BitId n) {
-    while (mParent.size() < n) {
-        addNode();
+    if (mSize < n) mSize = n;
+}
+
+UnionFindBits::UnionFindBits(const UnionFindBits& o) { *this = o; }
+
+UnionFindBits& UnionFindBits::operator=(const UnionFindBits& o) {
+    if (this == &o) return *this;
+    mSize = o.mSize;
+    mPageStore.clear();
+    mParentPages.assign(o.mParentPages.size(), nullptr);
+    mRankPages.assign(o.mRankPages.size(), nullptr);
+    for (size_t pg = 0; pg < o.mParentPages.size(); ++pg) {
+        if (!o.mParentPages[pg]) continue;
+        auto& page = mPageStore.emplace_back(std::make_unique<Page>());
+        std::copy_n(o.mParentPages[pg], kPageSize, page->mParent);
+        std::copy_n(o.mRankPages[pg], kPageSize, page->mRank);
+        mParentPages[pg] = page->mParent;
+        mRankPages[pg] = page->mRank;
     }
+    return *this;
+}
+
+void UnionFindBits::touch(BitId x) {
+    uint32_t pg = x >> kPageBits;
+    if (pg >= mParentPages.size()) {
+        mParentPages.resize(pg + 1, nullptr);
+        mRankPages.resize(pg + 1, nullptr);
+    }
+    if (mParentPages[pg]) return;
+    auto& page = mPageStore.emplace_back(std::make_unique<Page>());
+    std::iota(page->mParent, page->mParent + kPageSize, pg << kPageBits);
+    std::fill_n(page->mRank, kPageSize, uint8_t{0});
+    mParentPages[pg] = page->mParent;
+    mRankPages[pg] = page->mRank;
 }
 
 BitId UnionFindBits::find(BitId x) {
-    if (mParent[x] != x) mParent[x] = find(mParent[x]);
-    return mParent[x];
+    BitId r = x;
+    for (BitId p = parent(r); p != r; p = parent(r))
+        r = p;
+    // Path compression. Any non-root bit already has its page materialized.
+    while (x != r) {
+        BitId& px = mParentPages[x >> kPageBits][x & (kPageSize - 1)];
+        BitId next = px;
+        px = r;
+        x = next;
+    }
+    return r;
 }
 
 void UnionFindBits::unite(BitId a, BitId b) {
     a = find(a);
     b = find(b);
     if (a == b) return;
-    if (mRank[a] < mRank[b]) std::swap(a, b);
-    mParent[b] = a;
-    if (mRank[a] == mRank[b]) mRank[a]++;
+    touch(a);
+    touch(b);
+    uint8_t& ra = mRankPages[a >> kPageBits][a & (kPageSize - 1)];
+    uint8_t& rb = mRankPages[b >> kPageBits][b & (kPageSize - 1)];
+    if (ra < rb) {
+        mParentPages[a >> kPageBits][a & (kPageSize - 1)] = b;
+        return;
+    }
+    mParentPages[b >> kPageBits][b & (kPageSize - 1)] = a;
+    if (ra == rb) ++ra;
+}
+
+void UnionFindBits::snapshotParents(BitId* out) const {
+    for (BitId base = 0; base < mSize; base += kPageSize) {
+        uint32_t pg = base >> kPageBits;
+        BitId n = std::min<BitId>(kPageSize, mSize - base);
+        if (pg < mParentPages.size() && mParentPages[pg]) {
+            std::copy_n(mParentPages[pg], n, out + base);
+        } else {
+            std::iota(out + base, out + base + n, base);
+        }
+    }
+}
+
+void UnionFindBits::storeParents(const BitId* roots) {
+    for (uint32_t pg = 0; pg < mParentPages.size(); ++pg) {
+        BitId* page = mParentPages[pg];
+        if (!page) continue;
+        BitId base = pg << kPageBits;
+        if (base >= mSize) break;
+        BitId n = std::min<BitId>(kPageSize, mSize - base);
+        std::copy_n(roots + base, n, page);
+    }
+}
+
+size_t UnionFindBits::pageCount() const { return mPageStore.size(); }
+
+size_t UnionFindBits::memoryBytes() const {
+    return mParentPages.capacity() * sizeof(BitId*) +
+           mRankPages.capacity() * sizeof(uint8_t*) +
+           mPageStore.capacity() * sizeof(mPageStore[0]) +
+           mPageStore.size() * sizeof(Page);
 }
 
 // End of UnionFindBits
 // -------------------------------------------
+// ConcurrentUnionFindBits
+BitId ConcurrentUnionFindBits::addNode() {
+    BitId idx = static_cast<BitId>(mParent.size());
+    mParent.push_back(idx);
+    return idx;
+}
+
+void ConcurrentUnionFindBits::ensureSize(BitId n) {
+    while (mParent.size() < n) {
+        addNode();
+    }
+}
+
+BitId ConcurrentUnionFindBits::find(BitId x) {
+    while (true) {
+        std::atomic_ref<BitId> px(mParent[x]);
+        BitId p = px.load(std::memory_order_acquire);
+        if (p == x) return x;
+        BitId gp =
+          std::atomic_ref<BitId>(mParent[p]).load(std::memory_order_acquire);
+        // Path halving: a lost race only means another thread already moved
+        // x closer to the root, so the result is ignored.
+        if (gp != p) {
+            px.compare_exchange_weak(
+              p, gp, std::memory_order_release, std::memory_order_relaxed);
+        }
+        x = gp;
+    }
+}
+
+void ConcurrentUnionFindBits::unite(BitId a, BitId b) {
+    while (true) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        BitId expected = a;
+        if (std::atomic_ref<BitId>(mParent[a]).compare_exchange_strong(
+              expected, b, std::memory_order_acq_rel)) {
+            return;
+        }
+        // a stopped being a root meanwhile; retry from the new roots.
+    }
+}
+
+// End of ConcurrentUnionFindBits
+// -------------------------------------------
 // Connectivity
+void Connectivity::setMode(UnionFindMode mode) {
+    if (mode == mMode) return;
+    restoreUnionFind();
+    if (mode == UnionFindMode::Concurrent) {
+        mCuf = ConcurrentUnionFindBits{};
+        mCuf.ensureSize(mNextId);
+        for (BitId i = 0; i < mNextId; ++i) {
+            BitId r = mUf.find(i);
+            if (r != i) mCuf.unite(i, r);
+        }
+        mUf = UnionFindBits{};
+    } else {
+        mUf = UnionFindBits{};
+        mUf.ensureSize(mNextId);
+        for (BitId i = 0; i < mNextId; ++i) {
+            BitId r = mCuf.find(i);
+            if (r != i) mUf.unite(i, r);
+        }
+        mCuf = ConcurrentUnionFindBits{};
+    }
+    mMode = mode;
+}
+
 BitId Connectivity::allocRange(uint32_t width) {
+    restoreUnionFind();
+    mFrozen = false;
     BitId base = mNextId;
-    mUf.ensureSize(base + width);
+    if (mMode == UnionFindMode::Concurrent) mCuf.ensureSize(base + width);
+    else mUf.ensureSize(base + width);
     mNextId += width;
     return base;
 }
 
 BitId Connectivity::size() const { return mNextId; }
 
+size_t Connectivity::memoryBytes() const {
+    return mUf.memoryBytes() + mCuf.memoryBytes() +
+           mNetOf.memoryBytes() + mNetOffsets.memoryBytes() +
+           mNetBits.memoryBytes();
+}
+
 void Connectivity::alias(BitId a, BitId b) {
     if (a >= mNextId || b >= mNextId) return; // guard for demo
+    if (mMode == UnionFindMode::Concurrent) {
+        mCuf.unite(a, b);
+        return;
+    }
+    restoreUnionFind();
+    mFrozen = false;
     mUf.unite(a, b);
 }
 
 NetId Connectivity::netId(BitId id) {
     if (id >= mNextId) return id;
-    return mUf.find(id);
+    if (!mFrozen) freeze();
+    return mNetOf[id];
 }
 
-std::vector<std::vector<BitId>> Connectivity::collectGroups() {
-    std::unordered_map<NetId, std::vector<BitId>> m;
-    m.reserve(mNextId);
-    for (BitId i = 0; i < mNextId; ++i) {
-        m[mUf.find(i)].push_back(i);
+// Pointer jumping until every entry points at its root. Each sweep is a
+// plain gather over the array, and the number of sweeps is logarithmic in
+// the tallest tree.
+static void flattenParents(BitId* parent, BitId n) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (BitId i = 0; i < n; ++i) {
+            BitId gp = parent[parent[i]];
+            changed |= (gp != parent[i]);
+            parent[i] = gp;
+        }
+    }
+}
+
+void Connectivity::freeze() {
+    restoreUnionFind();
+    const BitId n = mNextId;
+    // Built in scratch vectors, then frozen (and possibly spilled) in one go.
+    std::vector<NetId> netOf(n);
+    if (mMode == UnionFindMode::Concurrent) {
+        flattenParents(mCuf.mParent.data(), n);
+        std::copy_n(mCuf.mParent.begin(), n, netOf.begin());
+    } else {
+        // Flatten a dense snapshot (absent pages expand to identity) and
+        // write the roots back into the materialized pages.
+        mUf.snapshotParents(netOf.data());
+        flattenParents(netOf.data(), n);
+        mUf.storeParents(netOf.data());
+    }
+
+    // Number roots in order of first appearance, i.e. smallest member.
+    // netOf holds roots here and is relabelled in place.
+    std::vector<NetId> rootLabel(n, UINT32_MAX);
+    NetId nets = 0;
+    for (BitId i = 0; i < n; ++i) {
+        NetId& l = rootLabel[netOf[i]];
+        if (l == UINT32_MAX) l = nets++;
+        netOf[i] = l;
     }
-    std::vector<std::vector<BitId>> g;
-    g.reserve(m.size());
-    for (auto& kv : m)
-        g.push_back(std::move(kv.second));
-    return g;
+
+    // Counting sort into the CSR index; bits stay ascending within a net.
+    std::vector<uint32_t> offsets(static_cast<size_t>(nets) + 1, 0);
+    for (BitId i = 0; i < n; ++i)
+        ++offsets[netOf[i] + 1];
+    for (NetId k = 0; k < nets; ++k)
+        offsets[k + 1] += offsets[k];
+    std::vector<BitId> bits(n);
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (BitId i = 0; i < n; ++i)
+        bits[cursor[netOf[i]]++] = i;
+    mNetOf = std::move(netOf);
+    mNetOffsets = std::move(offsets);
+    mNetBits = std::move(bits);
+    mFrozen = true;
+    if (mMode == UnionFindMode::Sequential && mNetOf.spilled())
+        releaseUnionFind();
+}
+
+void Connectivity::releaseUnionFind() {
+    mUf = UnionFindBits{};
+    mUfReleased = true;
+}
+
+// Link every bit to the smallest bit of its net, straight from the frozen
+// index (still valid: it is only replaced by the next freeze()). Only the
+// Sequential union-find is ever released, and setMode() restores it
+// before switching, so this never runs beside a parallel alias().
+void Connectivity::restoreUnionFind() {
+    if (!mUfReleased) return;
+    mUfReleased = false;
+    const BitId n = static_cast<BitId>(mNetOf.size());
+    const NetId* netOf = mNetOf.data();
+    const uint32_t* offsets = mNetOffsets.data();
+    const BitId* bits = mNetBits.data();
+    mUf.ensureSize(n);
+    for (BitId i = 0; i < n; ++i) {
+        BitId root = bits[offsets[netOf[i]]];
+        if (root != i) mUf.unite(i, root);
+    }
+}
+
+NetGroups Connectivity::groups() {
+    if (!mFrozen) freeze();
+    return static_cast<const Connectivity&>(*this).groups();
 }
 
 void Connectivity::dump(std::ostream& os,
                         const std::function<std::string(BitId)>& renderBit) {
-    auto groups = collectGroups();
-    os << "Connectivity groups (" << groups.size() << "):\n";
-    for (auto& grp : groups) {
+    auto nets = groups();
+    os << "Connectivity groups (" << nets.size() << "):\n";
+    for (auto grp : nets) {
         os << "  { ";
         for (size_t i = 0; i < grp.size(); ++i) {
             os << renderBit(grp[i]);
@@ -81,4 +327,4 @@ void Connectivity::dump(std::ostream& os,
 // End of Connectivity
 // -------------------------------------------
 
-} // namespace hdl::net
\ No newline at end of file
+} // namespace hdl::net
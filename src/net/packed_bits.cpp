@@ -0,0 +1,209 @@
+#include "hdl/net/packed_bits.hpp"
+
+#include <algorithm>
+
+namespace hdl::net {
+
+namespace {
+
+// Offsets decode first; escaped slots are then patched in order.
+template <typename T>
+void decodeFor(const T* p, uint32_t n, BitId base, const uint32_t* exc,
+               BitId* out) {
+    constexpr T kEsc = static_cast<T>(~T(0));
+    for (uint32_t k = 0; k < n; ++k)
+        out[k] = base + p[k];
+    for (uint32_t k = 0; k < n; ++k)
+        if (p[k] == kEsc) out[k] = *exc++;
+}
+
+constexpr int8_t kDeltaEsc = INT8_MIN;
+
+void decodeDelta(const uint8_t* p, uint32_t n, BitId prev, const uint32_t* exc,
+                 BitId* out) {
+    for (uint32_t k = 0; k < n; ++k) {
+        int8_t d = static_cast<int8_t>(p[k]);
+        prev = d == kDeltaEsc ? *exc++ : prev + static_cast<uint32_t>(d);
+        out[k] = prev;
+    }
+}
+
+// Largest number of sorted values inside one window [x, x + width).
+uint32_t bestWindow(const std::vector<BitId>& sorted, uint64_t width,
+                    BitId& base) {
+    uint32_t best = 0;
+    base = sorted.empty() ? 0 : sorted[0];
+    for (size_t lo = 0, hi = 0; lo < sorted.size(); ++lo) {
+        hi = std::max(hi, lo);
+        while (hi < sorted.size() && uint64_t(sorted[hi]) - sorted[lo] < width)
+            ++hi;
+        if (hi - lo > best) {
+            best = static_cast<uint32_t>(hi - lo);
+            base = sorted[lo];
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+PackedBitArray::PackedBitArray(std::span<const BitId> values)
+    : mSize(values.size()) {
+    const size_t blocks = (mSize + kBlock - 1) / kBlock;
+    mModes.reserve(blocks);
+    mBase.reserve(blocks);
+    mAux.reserve(blocks);
+    mExc.reserve(blocks);
+    std::vector<BitId> sorted;
+    for (size_t lo = 0; lo < mSize; lo += kBlock) {
+        auto v = values.subspan(lo, std::min<size_t>(kBlock, mSize - lo));
+        const uint32_t n = static_cast<uint32_t>(v.size());
+
+        // Arithmetic progression, wrapping (stride 0 and -1 included).
+        uint32_t stride = n > 1 ? v[1] - v[0] : 0;
+        uint32_t k = 1;
+        while (k < n && v[k] == v[0] + k * stride)
+            ++k;
+        if (k == n) {
+            mModes.push_back(Mode::Stride);
+            mBase.push_back(v[0]);
+            mAux.push_back(stride);
+            mExc.push_back(0);
+            continue;
+        }
+
+        // Patched frame of reference: the all-ones code is the escape, so
+        // a window holds 2^w - 1 offsets.
+        sorted.assign(v.begin(), v.end());
+        std::sort(sorted.begin(), sorted.end());
+        BitId base8 = 0, base16 = 0;
+        uint32_t in8 = bestWindow(sorted, 0xffu, base8);
+        uint32_t in16 = bestWindow(sorted, 0xffffu, base16);
+        size_t cost8 = n + (n - in8) * 4;
+        size_t cost16 = n * 2 + (n - in16) * 4;
+        uint32_t misses = 0; // delta: first value and every big jump
+        for (uint32_t j = 0; j < n; ++j) {
+            int64_t d = j ? int64_t(v[j]) - v[j - 1] : INT64_MAX;
+            misses += d <= kDeltaEsc || d > INT8_MAX;
+        }
+        size_t costDelta = n + misses * 4;
+        size_t costRaw = n * 4;
+        auto put = [&](Mode m, BitId base, uint64_t width, auto& payload) {
+            using T = typename std::decay_t<decltype(payload)>::value_type;
+            mModes.push_back(m);
+            mBase.push_back(base);
+            mAux.push_back(static_cast<uint32_t>(payload.size()));
+            mExc.push_back(static_cast<uint32_t>(mP32.size()));
+            for (BitId x : v) {
+                bool in = x >= base && uint64_t(x) - base < width;
+                payload.push_back(in ? static_cast<T>(x - base)
+                                     : static_cast<T>(~T(0)));
+                if (!in) mP32.push_back(x);
+            }
+        };
+        if (costDelta < cost8 && costDelta < cost16 && costDelta < costRaw) {
+            mModes.push_back(Mode::Delta8);
+            mBase.push_back(0);
+            mAux.push_back(static_cast<uint32_t>(mP8.size()));
+            mExc.push_back(static_cast<uint32_t>(mP32.size()));
+            for (uint32_t j = 0; j < n; ++j) {
+                int64_t d = j ? int64_t(v[j]) - v[j - 1] : INT64_MAX;
+                bool fits = d > kDeltaEsc && d <= INT8_MAX;
+                mP8.push_back(static_cast<uint8_t>(
+                  fits ? static_cast<int8_t>(d) : kDeltaEsc));
+                if (!fits) mP32.push_back(v[j]);
+            }
+        } else if (cost8 <= cost16 && cost8 < costRaw) {
+            put(Mode::For8, base8, 0xffu, mP8);
+        } else if (cost16 < costRaw) {
+            put(Mode::For16, base16, 0xffffu, mP16);
+        } else {
+            mModes.push_back(Mode::Raw);
+            mBase.push_back(0);
+            mAux.push_back(static_cast<uint32_t>(mP32.size()));
+            mExc.push_back(0);
+            mP32.insert(mP32.end(), v.begin(), v.end());
+        }
+    }
+}
+
+BitId PackedBitArray::operator[](size_t i) const {
+    const size_t b = i / kBlock;
+    const uint32_t k = static_cast<uint32_t>(i % kBlock);
+    const BitId base = mBase[b];
+    auto patched = [&](const auto* p) -> BitId {
+        using T = std::decay_t<decltype(*p)>;
+        constexpr T kEsc = static_cast<T>(~T(0));
+        if (p[k] != kEsc) return base + p[k];
+        uint32_t e = mExc[b];
+        for (uint32_t j = 0; j < k; ++j)
+            e += p[j] == kEsc;
+        return mP32[e];
+    };
+    switch (mModes[b]) {
+    case Mode::Stride: return base + k * mAux[b];
+    case Mode::For8: return patched(mP8.data() + mAux[b]);
+    case Mode::For16: return patched(mP16.data() + mAux[b]);
+    case Mode::Delta8: {
+        BitId buf[kBlock];
+        decodeDelta(mP8.data() + mAux[b], k + 1, 0, mP32.data() + mExc[b],
+                    buf);
+        return buf[k];
+    }
+    case Mode::Raw: return mP32[mAux[b] + k];
+    }
+    return UINT32_MAX;
+}
+
+uint32_t PackedBitArray::decodeBlock(size_t b, BitId* out) const {
+    const size_t lo = b * kBlock;
+    const uint32_t n =
+      static_cast<uint32_t>(std::min<size_t>(kBlock, mSize - lo));
+    const BitId base = mBase[b];
+    const uint32_t* exc = mP32.data() + mExc[b];
+    switch (mModes[b]) {
+    case Mode::Stride: {
+        const uint32_t stride = mAux[b];
+        for (uint32_t k = 0; k < n; ++k)
+            out[k] = base + k * stride;
+        break;
+    }
+    case Mode::For8: decodeFor(mP8.data() + mAux[b], n, base, exc, out); break;
+    case Mode::For16:
+        decodeFor(mP16.data() + mAux[b], n, base, exc, out);
+        break;
+    case Mode::Delta8:
+        decodeDelta(mP8.data() + mAux[b], n, 0, exc, out);
+        break;
+    case Mode::Raw: std::copy_n(mP32.data() + mAux[b], n, out); break;
+    }
+    return n;
+}
+
+void PackedBitArray::decode(size_t first, size_t count, BitId* out) const {
+    BitId buf[kBlock];
+    const size_t end = first + count;
+    while (first < end) {
+        const size_t b = first / kBlock;
+        const size_t k = first % kBlock;
+        const size_t take = std::min<size_t>(kBlock - k, end - first);
+        if (k == 0 && take == kBlock) {
+            decodeBlock(b, out);
+        } else {
+            decodeBlock(b, buf);
+            std::copy_n(buf + k, take, out);
+        }
+        out += take;
+        first += take;
+    }
+}
+
+size_t PackedBitArray::memoryBytes() const {
+    return mModes.capacity() * sizeof(Mode) +
+           (mBase.capacity() + mAux.capacity() + mExc.capacity() +
+            mP32.capacity()) *
+             sizeof(uint32_t) +
+           mP8.capacity() + mP16.capacity() * sizeof(uint16_t);
+}
+
+} // namespace hdl::net
@@ -1,6 +1,7 @@
 #include <sstream>
 
 #include "hdl/hier/instance.hpp"
+#include "hdl/tcl/channel_stream.hpp"
 #include "hdl/tcl/console.hpp"
 
 using hdl::tcl::Console;
@@ -36,20 +37,70 @@ static int cmd_dump_connectivity(Console& c, Tcl_Interp* ip,
     Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
     return TCL_OK;
 }
+// Returns the dump as the command result. With -channel (or -stdout) it
+// streams to that Tcl channel instead, so replicated hierarchies do not
+// have to fit in memory.
 static int cmd_dump_hierarchy(Console& c, Tcl_Interp* ip,
-                              const Console::Args&) {
+                              const Console::Args& a) {
+    hdl::elab::hier::DumpOptions opts;
+    std::string chanName;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-dedup") {
+            opts.mDedup = true;
+        } else if (a[i] == "-depth" && i + 1 < a.size()) {
+            try {
+                opts.mMaxDepth = (uint32_t)std::stoul(a[++i]);
+            } catch (...) {
+                Tcl_SetObjResult(ip, Tcl_NewStringObj("invalid -depth", -1));
+                return TCL_ERROR;
+            }
+        } else if (a[i] == "-channel" && i + 1 < a.size()) {
+            chanName = a[++i];
+        } else if (a[i] == "-stdout") {
+            chanName = "stdout";
+        } else {
+            Tcl_SetObjResult(
+              ip,
+              Tcl_NewStringObj("usage: hdl dump-hierarchy [-depth N] "
+                               "[-dedup] [-stdout | -channel chan]",
+                               -1));
+            return TCL_ERROR;
+        }
+    }
     if (c.selection().mModuleKeys.empty()) {
         Tcl_SetObjResult(ip, Tcl_NewStringObj("no modules selected", -1));
         return TCL_ERROR;
     }
-    std::ostringstream oss;
-    for (auto& key : c.selection().mModuleKeys) {
-        auto* s = c.getSpecByKey(key.str());
-        if (!s) continue;
-        oss << "=== " << key.str() << " ===\n";
-        hdl::elab::hier::dumpInstanceTree(*s, oss);
+    auto dump = [&](std::ostream& os) {
+        for (auto& key : c.selection().mModuleKeys) {
+            auto* s = c.getSpecByKey(key.str());
+            if (!s) continue;
+            os << "=== " << key.str() << " ===\n";
+            hdl::elab::hier::dumpInstanceTree(*s, os, opts);
+        }
+    };
+    if (chanName.empty()) {
+        std::ostringstream oss;
+        dump(oss);
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+        return TCL_OK;
+    }
+    int mode = 0;
+    Tcl_Channel chan = Tcl_GetChannel(ip, chanName.c_str(), &mode);
+    if (!chan) return TCL_ERROR;
+    if (!(mode & TCL_WRITABLE)) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("channel is not open for writing", -1));
+        return TCL_ERROR;
+    }
+    hdl::tcl::ChannelBuf buf(chan);
+    std::ostream os(&buf);
+    dump(os);
+    os.flush();
+    if (!buf.ok()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("write to channel failed", -1));
+        return TCL_ERROR;
     }
-    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
     return TCL_OK;
 }
 
@@ -62,7 +113,9 @@ void register_cmd_dump(Console& c) {
                       "Print connectivity groups for selected modules: dump-connectivity",
                       &cmd_dump_connectivity);
     c.registerCommand("dump-hierarchy",
-                      "Print instance hierarchy for selected modules: dump-hierarchy",
+                      "Print instance hierarchy for selected modules: "
+                      "dump-hierarchy [-depth N] [-dedup] "
+                      "[-stdout | -channel chan]",
                       &cmd_dump_hierarchy);
 }
 } // namespace hdl::tcl
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include <chrono>
+#include <sstream>
+
+#include "hdl/hier/flat_graph.hpp"
+#include "hdl/hier/loops.hpp"
+#include "hdl/hier/rollup.hpp"
+#include "hdl/hier/walk.hpp"
+#include "hdl/hier/where_used.hpp"
+#include "hdl/tcl/channel_stream.hpp"
+#include "hdl/tcl/console.hpp"
+
+using hdl::tcl::Console;
+
+static int cmd_flatten_design(Console& c, Tcl_Interp* ip,
+                              const Console::Args& a) {
+    hdl::IdString key = c.selection().mPrimaryKey;
+    hdl::elab::hier::FlatGraphOptions opts;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if ((a[i] == "-budget" || a[i] == "-threads") && i + 1 < a.size()) {
+            try {
+                if (a[i] == "-budget")
+                    opts.mMemoryBudget = std::stoull(a[i + 1]);
+                else
+                    opts.mThreads = (unsigned)std::stoul(a[i + 1]);
+            } catch (...) {
+                Tcl_SetObjResult(
+                  ip, Tcl_NewStringObj(("invalid " + a[i]).c_str(), -1));
+                return TCL_ERROR;
+            }
+            ++i;
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            key = hdl::IdString::tryLookup(a[i]);
+        } else {
+            Tcl_SetObjResult(
+              ip,
+              Tcl_NewStringObj("usage: hdl flatten-design [specKey] "
+                               "[-budget BYTES] [-threads N]",
+                               -1));
+            return TCL_ERROR;
+        }
+    }
+    if (!key.valid()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("no module context", -1));
+        return TCL_ERROR;
+    }
+    auto* s = c.getSpecByKey(key.str());
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream diag;
+    auto t0 = std::chrono::steady_clock::now();
+    hdl::elab::hier::GlobalNetResolver resolver(*s, &diag);
+    hdl::elab::hier::FlatGraph g;
+    if (!hdl::elab::hier::buildFlatGraph(*s, resolver, opts, g, &diag)) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(diag.str().c_str(), -1));
+        return TCL_ERROR;
+    }
+    auto ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - t0)
+                .count();
+    std::ostringstream oss;
+    oss << "instances=" << g.instanceCount() << " pins=" << g.pinCount()
+        << " nets=" << g.netCount() << " bytes=" << g.memoryBytes()
+        << " ms=" << ms;
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+static int cmd_stats(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    hdl::IdString key;
+    if (a.size() == 1) key = hdl::IdString::tryLookup(a[0]);
+    else if (a.empty()) key = c.selection().mPrimaryKey;
+    else {
+        Tcl_SetObjResult(ip,
+                         Tcl_NewStringObj("usage: hdl stats [specKey]", -1));
+        return TCL_ERROR;
+    }
+    if (!key.valid()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("no module context", -1));
+        return TCL_ERROR;
+    }
+    auto* s = c.getSpecByKey(key.str());
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream diag;
+    hdl::elab::hier::RollupTable rt(*s, &diag);
+    const auto& r = rt.of(*s);
+    std::ostringstream oss;
+    oss << diag.str() << "instances=" << r.mInstances
+        << " leaf_instances=" << r.mLeafInstances
+        << " leaf_pins=" << r.mLeafPins << " bits=" << r.mBits
+        << " nets=" << r.mNets << " depth=" << r.mDepth
+        << " specs=" << rt.specCount();
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// One line per instance path, returned as the command result. With
+// -channel (or -stdout) the lines are streamed as the walk proceeds.
+static int cmd_list_instances(Console& c, Tcl_Interp* ip,
+                              const Console::Args& a) {
+    hdl::IdString key = c.selection().mPrimaryKey;
+    hdl::elab::hier::WalkOptions opts;
+    opts.mInternScopes = false;
+    std::string chanName;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-depth" && i + 1 < a.size()) {
+            try {
+                opts.mMaxDepth = (uint32_t)std::stoul(a[++i]);
+            } catch (...) {
+                Tcl_SetObjResult(ip, Tcl_NewStringObj("invalid -depth", -1));
+                return TCL_ERROR;
+            }
+        } else if (a[i] == "-prune" && i + 1 < a.size()) {
+            opts.mPruneModules.push_back(hdl::IdString(a[++i]));
+        } else if (a[i] == "-channel" && i + 1 < a.size()) {
+            chanName = a[++i];
+        } else if (a[i] == "-stdout") {
+            chanName = "stdout";
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            key = hdl::IdString::tryLookup(a[i]);
+        } else {
+            Tcl_SetObjResult(
+              ip,
+              Tcl_NewStringObj("usage: hdl list-instances [specKey] "
+                               "[-depth N] [-prune module]... "
+                               "[-stdout | -channel chan]",
+                               -1));
+            return TCL_ERROR;
+        }
+    }
+    if (!key.valid()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("no module context", -1));
+        return TCL_ERROR;
+    }
+    auto* s = c.getSpecByKey(key.str());
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    auto list = [&](std::ostream& os) {
+        hdl::elab::hier::ScopeTable scopes(*s);
+        std::vector<const hdl::IdString*> names;
+        for (const auto& v : hdl::elab::hier::walkInstances(
+               scopes, hdl::elab::hier::kRootScope, opts)) {
+            names.resize(v.mDepth - 1);
+            names.push_back(&v.mInst->mName);
+            for (size_t i = 0; i < names.size(); ++i)
+                os << (i ? "/" : "") << names[i]->str();
+            os << " : " << v.mInst->mCallee->mName.str() << "\n";
+        }
+    };
+    if (chanName.empty()) {
+        std::ostringstream oss;
+        list(oss);
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+        return TCL_OK;
+    }
+    int mode = 0;
+    Tcl_Channel chan = Tcl_GetChannel(ip, chanName.c_str(), &mode);
+    if (!chan) return TCL_ERROR;
+    if (!(mode & TCL_WRITABLE)) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("channel is not open for writing", -1));
+        return TCL_ERROR;
+    }
+    hdl::tcl::ChannelBuf buf(chan);
+    std::ostream os(&buf);
+    list(os);
+    os.flush();
+    if (!buf.ok()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("write to channel failed", -1));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+// where-used <specKey|module> [-paths] [-limit N] [-top specKey]
+// A module name selects every elaborated specialization of it.
+static int cmd_where_used(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    std::string target;
+    hdl::IdString topKey = c.selection().mPrimaryKey;
+    bool paths = false;
+    size_t limit = 100;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-paths") {
+            paths = true;
+        } else if (a[i] == "-limit" && i + 1 < a.size()) {
+            try {
+                limit = std::stoul(a[++i]);
+            } catch (...) {
+                Tcl_SetObjResult(ip, Tcl_NewStringObj("invalid -limit", -1));
+                return TCL_ERROR;
+            }
+        } else if (a[i] == "-top" && i + 1 < a.size()) {
+            topKey = hdl::IdString::tryLookup(a[++i]);
+        } else if (target.empty() && !a[i].empty() && a[i][0] != '-') {
+            target = a[i];
+        } else {
+            target.clear();
+            break;
+        }
+    }
+    if (target.empty()) {
+        Tcl_SetObjResult(
+          ip,
+          Tcl_NewStringObj("usage: hdl where-used <specKey|module> [-paths] "
+                           "[-limit N] [-top specKey]",
+                           -1));
+        return TCL_ERROR;
+    }
+    std::vector<const hdl::elab::ModuleSpec*> specs;
+    if (auto* s = c.getSpecByKey(target)) {
+        specs.push_back(s);
+    } else {
+        for (auto& [key, s] : c.specLib())
+            if (!s.mAliasOf && s.mName.str() == target) specs.push_back(&s);
+    }
+    if (specs.empty()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown spec or module", -1));
+        return TCL_ERROR;
+    }
+
+    std::ostringstream oss;
+    for (const auto& u : hdl::elab::hier::whereUsed(specs)) {
+        const auto& inst = u.mParent->mInstances[u.mInstIndex];
+        oss << hdl::elab::makeModuleKey(u.mParent->mName.str(),
+                                        u.mParent->mEnv)
+            << " " << inst.mName.str() << " [" << u.mInstIndex << "] ports:";
+        for (const auto& conn : inst.mConns)
+            oss << " " << inst.mCallee->mPorts[conn.mFormalIndex].mName.str();
+        oss << "\n";
+    }
+    if (paths) {
+        auto* top = topKey.valid() ? c.getSpecByKey(topKey.str()) : nullptr;
+        if (!top) {
+            Tcl_SetObjResult(ip, Tcl_NewStringObj("no top for -paths", -1));
+            return TCL_ERROR;
+        }
+        for (const auto* s : specs) {
+            hdl::elab::hier::RootPaths rp(*top, *s);
+            oss << "paths from " << topKey.str() << ": " << rp.count()
+                << "\n";
+            rp.forEach([&](const hdl::elab::hier::ScopeId& p) {
+                if (limit == 0) return false;
+                --limit;
+                const hdl::elab::ModuleSpec* cur = top;
+                oss << "  ";
+                for (size_t i = 0; i < p.mPath.size(); ++i) {
+                    const auto& inst = cur->mInstances[p.mPath[i]];
+                    oss << (i ? "/" : "") << inst.mName.str();
+                    cur = inst.mCallee;
+                }
+                oss << "\n";
+                return true;
+            });
+        }
+    }
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// find-loops [specKey] [-budget B] [-threads N]: combinational loops in
+// every spec reachable from the top, one line per loop.
+static int cmd_find_loops(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    hdl::IdString key = c.selection().mPrimaryKey;
+    hdl::elab::hier::LoopOptions opts;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if ((a[i] == "-budget" || a[i] == "-threads") && i + 1 < a.size()) {
+            try {
+                if (a[i] == "-budget")
+                    opts.mMemoryBudget = std::stoull(a[i + 1]);
+                else
+                    opts.mThreads = (unsigned)std::stoul(a[i + 1]);
+            } catch (...) {
+                Tcl_SetObjResult(
+                  ip, Tcl_NewStringObj(("invalid " + a[i]).c_str(), -1));
+                return TCL_ERROR;
+            }
+            ++i;
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            key = hdl::IdString::tryLookup(a[i]);
+        } else {
+            Tcl_SetObjResult(ip,
+                             Tcl_NewStringObj("usage: hdl find-loops [specKey] "
+                                              "[-budget BYTES] [-threads N]",
+                                              -1));
+            return TCL_ERROR;
+        }
+    }
+    auto* s = key.valid() ? c.getSpecByKey(key.str()) : nullptr;
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream diag;
+    hdl::elab::hier::RollupTable rt(*s, &diag);
+    std::vector<hdl::elab::hier::ModuleLoops> res;
+    bool ok = hdl::elab::hier::findCombLoops(rt.order(), opts, res, &diag);
+    std::ostringstream oss;
+    size_t loops = 0;
+    for (const auto& m : res) {
+        for (const auto& loop : m.mLoops) {
+            ++loops;
+            oss << hdl::elab::makeModuleKey(m.mSpec->mName.str(),
+                                            m.mSpec->mEnv)
+                << ": " << loop.size() << " bits:";
+            // Long loops are elided after a handful of labels.
+            for (size_t k = 0; k < loop.size() && k < 16; ++k)
+                oss << " " << m.mSpec->renderBit(loop[k]);
+            if (loop.size() > 16) oss << " ...";
+            oss << "\n";
+        }
+    }
+    oss << diag.str() << "loops=" << loops;
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return ok ? TCL_OK : TCL_ERROR;
+}
+
+namespace hdl::tcl {
+void register_cmd_hier(Console& c) {
+    c.registerCommand("flatten-design",
+                      "Build the flat leaf-pin/net graph: flatten-design "
+                      "[specKey] [-budget BYTES] [-threads N]",
+                      &cmd_flatten_design);
+    c.registerCommand("find-loops",
+                      "Report combinational loops through assigns and "
+                      "feedthrough children: find-loops [specKey] "
+                      "[-budget BYTES] [-threads N]",
+                      &cmd_find_loops);
+    c.registerCommand("stats",
+                      "Flattened instance/bit/net totals: stats [specKey]",
+                      &cmd_stats);
+    c.registerCommand("list-instances",
+                      "List instance paths: list-instances [specKey] "
+                      "[-depth N] [-prune module]... "
+                      "[-stdout | -channel chan]",
+                      &cmd_list_instances);
+    c.registerCommand("where-used",
+                      "Instantiations of a spec or module: where-used "
+                      "<specKey|module> [-paths] [-limit N] [-top specKey]",
+                      &cmd_where_used);
+}
+} // namespace hdl::tcl
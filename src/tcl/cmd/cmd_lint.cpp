@@ -0,0 +1,143 @@
+#include <sstream>
+
+#include "hdl/elab/lint.hpp"
+#include "hdl/hier/const_prop.hpp"
+#include "hdl/hier/rollup.hpp"
+#include "hdl/tcl/console.hpp"
+
+using hdl::tcl::Console;
+
+// lint [specKey] [-kind K] [-limit N] [-threads N]: counts per kind, then
+// up to N rows (default 20) of the requested kind or of all kinds.
+static int cmd_lint(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    hdl::IdString key = c.selection().mPrimaryKey;
+    bool byKind = false;
+    hdl::elab::LintKind kind{};
+    size_t limit = 20;
+    unsigned threads = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-kind" && i + 1 < a.size()) {
+            if (!hdl::elab::parseLintKind(a[++i], kind)) {
+                Tcl_SetObjResult(
+                  ip, Tcl_NewStringObj(("unknown lint kind " + a[i]).c_str(), -1));
+                return TCL_ERROR;
+            }
+            byKind = true;
+        } else if ((a[i] == "-limit" || a[i] == "-threads") &&
+                   i + 1 < a.size()) {
+            try {
+                if (a[i] == "-limit") limit = std::stoull(a[i + 1]);
+                else threads = (unsigned)std::stoul(a[i + 1]);
+            } catch (...) {
+                Tcl_SetObjResult(
+                  ip, Tcl_NewStringObj(("invalid " + a[i]).c_str(), -1));
+                return TCL_ERROR;
+            }
+            ++i;
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            key = hdl::IdString::tryLookup(a[i]);
+        } else {
+            Tcl_SetObjResult(
+              ip,
+              Tcl_NewStringObj("usage: hdl lint [specKey] [-kind K] "
+                               "[-limit N] [-threads N]",
+                               -1));
+            return TCL_ERROR;
+        }
+    }
+    auto* s = key.valid() ? c.getSpecByKey(key.str()) : nullptr;
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream oss;
+    hdl::elab::hier::RollupTable rt(*s, &oss);
+    auto table = hdl::elab::runLint(rt.order(), threads);
+    for (size_t k = 0; k < hdl::elab::kLintKinds; ++k) {
+        auto lk = static_cast<hdl::elab::LintKind>(k);
+        oss << (k ? " " : "") << to_string(lk) << "=" << table.count(lk);
+    }
+    oss << "\n";
+    for (const auto& r : table.rows()) {
+        if (byKind && r.mKind != kind) continue;
+        if (limit == 0) break;
+        --limit;
+        oss << hdl::elab::makeModuleKey(r.mSpec->mName.str(), r.mSpec->mEnv)
+            << " " << to_string(r.mKind) << " "
+            << hdl::elab::LintTable::describe(r) << "\n";
+    }
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// constants [specKey] [-conflicts] [-limit N]: per-spec constant/conflict
+// net counts, then up to N flagged nets (default 20).
+static int cmd_constants(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    hdl::IdString key = c.selection().mPrimaryKey;
+    bool conflictsOnly = false;
+    size_t limit = 20;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-conflicts") {
+            conflictsOnly = true;
+        } else if (a[i] == "-limit" && i + 1 < a.size()) {
+            try {
+                limit = std::stoull(a[++i]);
+            } catch (...) {
+                Tcl_SetObjResult(ip, Tcl_NewStringObj("invalid -limit", -1));
+                return TCL_ERROR;
+            }
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            key = hdl::IdString::tryLookup(a[i]);
+        } else {
+            Tcl_SetObjResult(ip,
+                             Tcl_NewStringObj("usage: hdl constants [specKey] "
+                                              "[-conflicts] [-limit N]",
+                                              -1));
+            return TCL_ERROR;
+        }
+    }
+    auto* s = key.valid() ? c.getSpecByKey(key.str()) : nullptr;
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream oss;
+    hdl::elab::hier::ConstTable ct(*s, &oss);
+    std::ostringstream rows;
+    for (const auto* spec : ct.order()) {
+        const auto& sc = ct.of(*spec);
+        auto specKey = hdl::elab::makeModuleKey(spec->mName.str(), spec->mEnv);
+        oss << specKey << ": const=" << sc.mConstNets
+            << " conflict=" << sc.mConflictNets << "\n";
+        const auto& bm = spec->mBitMap;
+        for (hdl::net::NetId n = 0; n < bm.netCount() && limit; ++n) {
+            auto v = sc.of(n);
+            if (v == hdl::elab::hier::ConstVal::Unknown) continue;
+            if (conflictsOnly && v != hdl::elab::hier::ConstVal::Conflict)
+                continue;
+            auto bits = bm.netGroups()[n];
+            if (bm.isTie(bits[0])) continue; // bare tie net
+            --limit;
+            rows << specKey << " " << spec->renderBit(bits[0]) << " = "
+                 << to_string(v) << "\n";
+        }
+    }
+    oss << rows.str();
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+namespace hdl::tcl {
+void register_cmd_lint(Console& c) {
+    c.registerCommand("lint",
+                      "Structural lint counts and rows: lint [specKey] "
+                      "[-kind undriven|multi-driven|floating-output|"
+                      "unused-wire|width-mismatch] [-limit N] [-threads N]",
+                      &cmd_lint);
+    c.registerCommand("constants",
+                      "Nets fixed to 0/1 or in conflict after constant "
+                      "propagation: constants [specKey] [-conflicts] "
+                      "[-limit N]",
+                      &cmd_constants);
+}
+} // namespace hdl::tcl
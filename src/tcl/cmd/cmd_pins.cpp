@@ -0,0 +1,266 @@
+#include <sstream>
+
+#include "hdl/hier/cone.hpp"
+#include "hdl/hier/port_model.hpp"
+#include "hdl/tcl/console.hpp"
+
+using hdl::tcl::Console;
+using hdl::tcl::Selection;
+
+// Resolve a[0] under the spec named by a[1] (or the primary) and return the
+// canonical path; the error text lands in the interpreter result.
+static bool resolvePinArg(Console& c, Tcl_Interp* ip, const Console::Args& a,
+                          hdl::IdString& key,
+                          hdl::elab::hier::PathResolver*& r,
+                          hdl::elab::hier::HierPinRef& pin) {
+    key = (a.size() >= 2) ? hdl::IdString::tryLookup(a[1])
+                          : c.selection().mPrimaryKey;
+    if (!key.valid()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("no module context", -1));
+        return false;
+    }
+    r = c.pathResolver(key);
+    if (!r) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return false;
+    }
+    std::ostringstream err;
+    r->setDiag(&err);
+    bool ok = r->resolvePin(a[0], pin);
+    r->setDiag(nullptr);
+    if (!ok) Tcl_SetObjResult(ip, Tcl_NewStringObj(err.str().c_str(), -1));
+    return ok;
+}
+
+static int cmd_resolve_pin(Console& c, Tcl_Interp* ip,
+                           const Console::Args& a) {
+    if (a.empty() || a.size() > 2) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("usage: resolve-pin <path> [specKey]", -1));
+        return TCL_ERROR;
+    }
+    hdl::IdString key;
+    hdl::elab::hier::PathResolver* r = nullptr;
+    hdl::elab::hier::HierPinRef pin;
+    if (!resolvePinArg(c, ip, a, key, r, pin)) return TCL_ERROR;
+    const auto& spec = r->scopes().spec(pin.mPin.mScope);
+    std::ostringstream oss;
+    oss << r->pinPath(pin) << " module=" << spec.mName.str()
+        << " scope=" << r->scopes().toString(pin.mPin.mScope)
+        << " port=" << pin.mPin.mPortIndex;
+    if (!pin.mWholePort)
+        oss << " bitId="
+            << spec.mBitMap.portBit(pin.mPin.mPortIndex, pin.mBitOff);
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+static int cmd_select_pin(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    if (a.empty() || a.size() > 2) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("usage: select-pin <path> [specKey]", -1));
+        return TCL_ERROR;
+    }
+    hdl::IdString key;
+    hdl::elab::hier::PathResolver* r = nullptr;
+    hdl::elab::hier::HierPinRef pin;
+    if (!resolvePinArg(c, ip, a, key, r, pin)) return TCL_ERROR;
+    c.selection().addPin(hdl::tcl::SelPin{key, r->pinPath(pin)});
+    Tcl_SetObjResult(ip, Tcl_NewStringObj("OK", -1));
+    return TCL_OK;
+}
+static std::vector<std::string> rev_select_pin(Console& c, const std::string&,
+                                               const Console::Args& a,
+                                               const Selection& pre) {
+    std::vector<std::string> inv;
+    if (a.empty()) return inv;
+    hdl::IdString key =
+      (a.size() >= 2) ? hdl::IdString::tryLookup(a[1]) : pre.mPrimaryKey;
+    if (!key.valid()) return inv;
+    auto* r = c.pathResolver(key);
+    hdl::elab::hier::HierPinRef pin;
+    if (!r || !r->resolvePin(a[0], pin)) return inv;
+    hdl::tcl::SelPin ref{key, r->pinPath(pin)};
+    if (!pre.hasPin(ref))
+        inv.push_back("unselect-pin {" + ref.mPath + "} " + key.str());
+    return inv;
+}
+
+static int cmd_unselect_pin(Console& c, Tcl_Interp* ip,
+                            const Console::Args& a) {
+    if (a.empty() || a.size() > 2) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("usage: unselect-pin <path> [specKey]", -1));
+        return TCL_ERROR;
+    }
+    hdl::IdString key;
+    hdl::elab::hier::PathResolver* r = nullptr;
+    hdl::elab::hier::HierPinRef pin;
+    if (!resolvePinArg(c, ip, a, key, r, pin)) return TCL_ERROR;
+    c.selection().removePin(hdl::tcl::SelPin{key, r->pinPath(pin)});
+    Tcl_SetObjResult(ip, Tcl_NewStringObj("OK", -1));
+    return TCL_OK;
+}
+static std::vector<std::string> rev_unselect_pin(Console& c,
+                                                 const std::string&,
+                                                 const Console::Args& a,
+                                                 const Selection& pre) {
+    std::vector<std::string> inv;
+    if (a.empty()) return inv;
+    hdl::IdString key =
+      (a.size() >= 2) ? hdl::IdString::tryLookup(a[1]) : pre.mPrimaryKey;
+    if (!key.valid()) return inv;
+    auto* r = c.pathResolver(key);
+    hdl::elab::hier::HierPinRef pin;
+    if (!r || !r->resolvePin(a[0], pin)) return inv;
+    hdl::tcl::SelPin ref{key, r->pinPath(pin)};
+    if (pre.hasPin(ref))
+        inv.push_back("select-pin {" + ref.mPath + "} " + key.str());
+    return inv;
+}
+
+struct ConeArgs {
+    hdl::elab::hier::ConeOptions mOpts;
+    std::string mPin;
+    hdl::IdString mKey;
+};
+static bool parseConeArgs(Console& c, const Console::Args& a, ConeArgs& out,
+                          std::string& err) {
+    bool dirSet = false;
+    out.mKey = c.selection().mPrimaryKey;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == "-fanin" || a[i] == "-fanout") {
+            out.mOpts.mDir = a[i] == "-fanin" ? hdl::elab::hier::ConeDir::Fanin
+                                              : hdl::elab::hier::ConeDir::Fanout;
+            dirSet = true;
+        } else if (a[i] == "-abstract") {
+            out.mOpts.mModels = &c.portModels();
+        } else if ((a[i] == "-depth" || a[i] == "-threads") &&
+                   i + 1 < a.size()) {
+            try {
+                uint32_t v = (uint32_t)std::stoul(a[i + 1]);
+                if (a[i] == "-depth") out.mOpts.mMaxDepth = v;
+                else out.mOpts.mThreads = v;
+            } catch (...) {
+                err = "invalid " + a[i];
+                return false;
+            }
+            ++i;
+        } else if (!a[i].empty() && a[i][0] != '-' && out.mPin.empty()) {
+            out.mPin = a[i];
+        } else if (!a[i].empty() && a[i][0] != '-') {
+            out.mKey = hdl::IdString::tryLookup(a[i]);
+        } else {
+            dirSet = false;
+            break;
+        }
+    }
+    if (!dirSet || out.mPin.empty()) {
+        err = "usage: trace-cone -fanin|-fanout <pin> [-abstract] "
+              "[-depth N] [-threads N] [specKey]";
+        return false;
+    }
+    if (!out.mKey.valid()) {
+        err = "no module context";
+        return false;
+    }
+    return true;
+}
+
+// Traces the cone and returns the canonical paths of the pins it reaches.
+static bool runCone(Console& c, const ConeArgs& ca,
+                    std::vector<std::string>& pins,
+                    hdl::elab::hier::ConeResult& res, std::string& err) {
+    auto* r = c.pathResolver(ca.mKey);
+    if (!r) {
+        err = "unknown specKey";
+        return false;
+    }
+    std::ostringstream diag;
+    r->setDiag(&diag);
+    hdl::elab::hier::HierPinRef pin;
+    bool ok = r->resolvePin(ca.mPin, pin);
+    r->setDiag(nullptr);
+    if (!ok) {
+        err = diag.str();
+        return false;
+    }
+    const auto& spec = r->scopes().spec(pin.mPin.mScope);
+    if (pin.mWholePort && spec.mPorts[pin.mPin.mPortIndex].width() != 1) {
+        err = "pin needs a bit select";
+        return false;
+    }
+    auto bit = spec.mBitMap.portBit(pin.mPin.mPortIndex, pin.mBitOff);
+    if (!hdl::elab::hier::traceCone(
+          r->scopes(), pin.mPin.mScope, bit, ca.mOpts, res, &diag)) {
+        err = diag.str();
+        return false;
+    }
+    for (const auto& p : res.mPins) {
+        hdl::elab::hier::HierPinRef ref;
+        ref.mPin.mScope = p.mScope;
+        ref.mPin.mPortIndex = p.mPort;
+        ref.mBitOff = p.mBit;
+        ref.mWholePort = false;
+        pins.push_back(r->pinPath(ref));
+    }
+    return true;
+}
+
+static int cmd_trace_cone(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    ConeArgs ca;
+    std::string err;
+    std::vector<std::string> pins;
+    hdl::elab::hier::ConeResult res;
+    if (!parseConeArgs(c, a, ca, err) || !runCone(c, ca, pins, res, err)) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(err.c_str(), -1));
+        return TCL_ERROR;
+    }
+    for (const auto& p : pins)
+        c.selection().addPin(hdl::tcl::SelPin{ca.mKey, p});
+    std::ostringstream oss;
+    oss << "nets=" << res.mNets.size() << " pins=" << pins.size()
+        << " levels=" << res.mLevels;
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+// Runs after the forward command: addPin() only appends, so the pins the
+// cone added are the selection's tail past the pre-command size. Undo
+// replays that list instead of tracing the cone again.
+static std::vector<std::string> rev_trace_cone(Console& c, const std::string&,
+                                               const Console::Args&,
+                                               const Selection& pre) {
+    std::vector<std::string> inv;
+    const auto& pins = c.selection().mPins;
+    for (size_t i = pre.mPins.size(); i < pins.size(); ++i)
+        inv.push_back("unselect-pin {" + pins[i].mPath + "} " +
+                      pins[i].mSpecKey.str());
+    return inv;
+}
+
+namespace hdl::tcl {
+void register_cmd_pins(Console& c) {
+    c.registerCommand("resolve-pin",
+                      "Resolve a hierarchical pin path: resolve-pin "
+                      "<inst/inst.port[bit]> [specKey]",
+                      &cmd_resolve_pin);
+    c.registerCommand("select-pin",
+                      "Select a hierarchical pin: select-pin <path> [specKey]",
+                      &cmd_select_pin,
+                      nullptr,
+                      &rev_select_pin);
+    c.registerCommand(
+      "unselect-pin",
+      "Unselect a hierarchical pin: unselect-pin <path> [specKey]",
+      &cmd_unselect_pin,
+      nullptr,
+      &rev_unselect_pin);
+    c.registerCommand("trace-cone",
+                      "Select the pins of a fan-in/fan-out cone: trace-cone "
+                      "-fanin|-fanout <pin> [-abstract] [-depth N] "
+                      "[-threads N] [specKey]",
+                      &cmd_trace_cone,
+                      nullptr,
+                      &rev_trace_cone);
+}
+} // namespace hdl::tcl
@@ -87,6 +87,92 @@ static int cmd_render_bit(Console& c, Tcl_Interp* ip, const Console::Args& a) {
     return TCL_OK;
 }
 
+// Shared by fanout/fanin: [specKey] <port|wire> <name> <bitOff> -> net.
+static int fanQuery(Console& c, Tcl_Interp* ip, const Console::Args& a,
+                    bool loads) {
+    const char* usage = loads
+                          ? "usage: hdl fanout [specKey] <port|wire> <name> "
+                            "<bitOff>"
+                          : "usage: hdl fanin [specKey] <port|wire> <name> "
+                            "<bitOff>";
+    size_t idx = 0;
+    hdl::IdString key;
+    if (a.size() == 4) {
+        key = hdl::IdString::tryLookup(a[0]);
+        idx = 1;
+    } else if (a.size() == 3) {
+        key = c.selection().mPrimaryKey;
+    } else {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(usage, -1));
+        return TCL_ERROR;
+    }
+    if (!key.valid()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("no module context", -1));
+        return TCL_ERROR;
+    }
+    auto* s = c.getSpecByKey(key.str());
+    if (!s) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown specKey", -1));
+        return TCL_ERROR;
+    }
+    if (!s->mFanout.built()) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("spec is not linked", -1));
+        return TCL_ERROR;
+    }
+    auto name = hdl::IdString::tryLookup(a[idx + 1]);
+    uint32_t bitOff = 0;
+    try {
+        bitOff = (uint32_t)std::stoul(a[idx + 2]);
+    } catch (...) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("invalid bitOff", -1));
+        return TCL_ERROR;
+    }
+    hdl::net::BitId b = UINT32_MAX;
+    if (a[idx] == "port") b = s->portBit(name, bitOff);
+    else if (a[idx] == "wire") b = s->wireBit(name, bitOff);
+    if (b == UINT32_MAX) {
+        Tcl_SetObjResult(
+          ip, Tcl_NewStringObj("bit out of range or unknown name", -1));
+        return TCL_ERROR;
+    }
+    auto n = s->mBitMap.netOf(b);
+    auto eps = loads ? s->mFanout.loads(n) : s->mFanout.drivers(n);
+    std::ostringstream oss;
+    for (const auto& ep : eps) {
+        using hdl::elab::EndpointKind;
+        if (ep.mKind == EndpointKind::Const) {
+            oss << "const " << ep.mIndex << "\n";
+            continue;
+        }
+        if (ep.mKind == EndpointKind::Cell) {
+            const auto& pin = s->mPrims.type(ep.mIndex).mPins[ep.mPort];
+            oss << s->mPrims.mNames[ep.mIndex].str() << "."
+                << pin.mName.str() << " (" << hdl::to_string(pin.mDir)
+                << ")\n";
+            continue;
+        }
+        const hdl::elab::PortSpec* p = nullptr;
+        if (ep.mKind == EndpointKind::Port) {
+            p = &s->mPorts[ep.mIndex];
+            oss << "port ";
+        } else {
+            const auto& inst = s->mInstances[ep.mIndex];
+            p = &inst.mCallee->mPorts[ep.mPort];
+            oss << inst.mName.str() << ".";
+        }
+        oss << p->mName.str() << "[" << ep.mBit << "] ("
+            << hdl::to_string(p->mDir) << ")\n";
+    }
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+static int cmd_fanout(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    return fanQuery(c, ip, a, true);
+}
+static int cmd_fanin(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    return fanQuery(c, ip, a, false);
+}
+
 // Completion for: net-of [specKey] <port|wire> <name> <bitOff>
 static std::vector<std::string> compl_net_of(Console& c,
                                              const Console::Args& toks) {
@@ -267,5 +353,17 @@ void register_cmd_query(Console& c) {
       "Render a bit owner label: hdl render-bit [specKey] <bitId>",
       &cmd_render_bit,
       &compl_render_bit);
+    c.registerCommand(
+      "fanout",
+      "List loads on a bit's net: hdl fanout [specKey] <port|wire> <name> "
+      "<bitOff>",
+      &cmd_fanout,
+      &compl_net_of);
+    c.registerCommand(
+      "fanin",
+      "List drivers of a bit's net: hdl fanin [specKey] <port|wire> <name> "
+      "<bitOff>",
+      &cmd_fanin,
+      &compl_net_of);
 }
 } // namespace hdl::tcl
\ No newline at end of file
@@ -152,6 +152,9 @@ static std::vector<std::string> rev_unselect_module(Console& c,
     for (auto& r : pre.mWires)
         if (r.mSpecKey == key)
             inv.push_back("select-wire " + r.mName.str() + " " + key.str());
+    for (auto& r : pre.mPins)
+        if (r.mSpecKey == key)
+            inv.push_back("select-pin {" + r.mPath + "} " + key.str());
     if (pre.mPrimaryKey.valid())
         inv.push_back("set-primary " + pre.mPrimaryKey.str());
     return inv;
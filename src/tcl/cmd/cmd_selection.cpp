@@ -31,6 +31,11 @@ static int cmd_selection(Console& c, Tcl_Interp* ip, const Console::Args& a) {
             for (auto& r : c.selection().mWires)
                 oss << "    " << r.mSpecKey.str() << "." << r.mName.str()
                     << "\n";
+        oss << "  pins:\n";
+        if (c.selection().mPins.empty()) oss << "    <none>\n";
+        else
+            for (auto& r : c.selection().mPins)
+                oss << "    " << r.mSpecKey.str() << ": " << r.mPath << "\n";
         Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
         return TCL_OK;
     } else if (a[0] == "summary") {
@@ -54,7 +59,8 @@ static int cmd_selection(Console& c, Tcl_Interp* ip, const Console::Args& a) {
         oss << "Summary:\n  modules: " << modN
             << "\n  selected ports: " << portN << " (" << portBits
             << " bits)\n  selected wires: " << wireN << " (" << wireBits
-            << " bits)\n";
+            << " bits)\n  selected pins: " << c.selection().mPins.size()
+            << "\n";
         Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
         return TCL_OK;
     } else if (a[0] == "clear") {
@@ -79,6 +85,8 @@ static std::vector<std::string> rev_selection(Console&, const std::string&,
     for (auto& r : pre.mWires)
         inv.push_back("hdl select-wire " + r.mName.str() + " " +
                       r.mSpecKey.str());
+    for (auto& r : pre.mPins)
+        inv.push_back("hdl select-pin {" + r.mPath + "} " + r.mSpecKey.str());
     if (pre.mPrimaryKey.valid())
         inv.push_back("hdl set-primary " + pre.mPrimaryKey.str());
     return inv;
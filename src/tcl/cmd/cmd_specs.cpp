@@ -1,5 +1,9 @@
 #include "hdl/ast/decl.hpp"
+#include "hdl/elab/elaborate.hpp"
+#include "hdl/elab/fingerprint.hpp"
+#include "hdl/elab/prune.hpp"
 #include "hdl/tcl/console.hpp"
+#include "hdl/util/spill.hpp"
 
 #include <sstream>
 
@@ -25,8 +29,144 @@ static std::vector<std::string> compl_modules(Console& c,
 static int cmd_specs(Console& c, Tcl_Interp* ip, const Console::Args&) {
     std::ostringstream oss;
     for (auto& kv : c.specLib()) {
-        oss << kv.first.str() << "\n";
+        oss << kv.first.str();
+        if (const auto* a = kv.second.mAliasOf)
+            oss << " -> " << hdl::elab::makeModuleKey(a->mName.str(), a->mEnv);
+        oss << "\n";
+    }
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// merge-specs [-v]: collapse structurally identical specializations.
+static int cmd_merge_specs(Console& c, Tcl_Interp* ip,
+                           const Console::Args& a) {
+    bool verbose = !a.empty() && a[0] == "-v";
+    std::ostringstream oss;
+    auto st = hdl::elab::mergeEquivalentSpecs(c.specLib(),
+                                              verbose ? &oss : nullptr);
+    c.dropDerivedCaches();
+    oss << "specs=" << st.mSpecs << " merged=" << st.mMerged
+        << " bytes=" << st.mBytesBefore << "->" << st.mBytesAfter
+        << " reclaimed=" << st.reclaimed();
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// prune-wires [specKey]: drop unreferenced wires (all specs by default)
+static int cmd_prune_wires(Console& c, Tcl_Interp* ip,
+                           const Console::Args& a) {
+    std::vector<hdl::elab::ModuleSpec*> specs;
+    if (!a.empty()) {
+        auto* s = c.getSpecByKey(a[0]);
+        if (!s) {
+            Tcl_SetObjResult(ip, Tcl_NewStringObj("unknown spec", -1));
+            return TCL_ERROR;
+        }
+        specs.push_back(s);
+    } else {
+        for (auto& kv : c.specLib())
+            if (!kv.second.mAliasOf) specs.push_back(&kv.second);
+    }
+    std::ostringstream oss;
+    size_t saved = 0;
+    for (auto* s : specs) {
+        auto st = hdl::elab::pruneDeadWires(*s);
+        if (st.mWires == 0) continue;
+        saved += st.saved();
+        oss << s->mName.str() << ": wires=" << st.mWires
+            << " bits=" << st.mBits << " bytes=" << st.mBytesBefore << "->"
+            << st.mBytesAfter << "\n";
+    }
+    c.dropDerivedCaches();
+    oss << "saved=" << saved;
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// load-cells <file>: add primitive cells, then relink every spec so
+// instances of them move to the primitive tables.
+static int cmd_load_cells(Console& c, Tcl_Interp* ip,
+                          const Console::Args& a) {
+    if (a.size() != 1) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj("usage: load-cells <file>", -1));
+        return TCL_ERROR;
+    }
+    std::ostringstream oss;
+    if (!c.cells().loadFile(a[0], &oss)) {
+        Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+        return TCL_ERROR;
+    }
+    std::vector<hdl::elab::ModuleSpec*> specs;
+    for (auto& kv : c.specLib())
+        if (!kv.second.mAliasOf) specs.push_back(&kv.second);
+    size_t prims = 0;
+    for (auto* s : specs) {
+        hdl::elab::linkInstances(
+          *s, c.declLib(), c.specLib(), &oss, &c.cells());
+        prims += s->mPrims.size();
     }
+    c.dropDerivedCaches();
+    oss << "cells=" << c.cells().size() << " prims=" << prims;
+    Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+    return TCL_OK;
+}
+
+// spill                      -> store statistics
+// spill -dir D [-budget MB] [-min KB] | spill off
+// Reconfiguring refreezes every spec so its arrays move to the new home.
+static int cmd_spill(Console& c, Tcl_Interp* ip, const Console::Args& a) {
+    auto& store = hdl::SpillStore::global();
+    std::ostringstream oss;
+    if (!a.empty()) {
+        hdl::SpillOptions opts = store.options();
+        if (a.size() == 1 && a[0] == "off") {
+            opts.mDir.clear();
+        } else {
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (i + 1 >= a.size() ||
+                    (a[i] != "-dir" && a[i] != "-budget" && a[i] != "-min")) {
+                    Tcl_SetObjResult(
+                      ip,
+                      Tcl_NewStringObj("usage: spill [-dir D] [-budget MB] "
+                                       "[-min KB] | spill off",
+                                       -1));
+                    return TCL_ERROR;
+                }
+                try {
+                    if (a[i] == "-dir") opts.mDir = a[i + 1];
+                    else if (a[i] == "-budget")
+                        opts.mBudget = size_t(std::stoull(a[i + 1])) << 20;
+                    else opts.mMinBytes = size_t(std::stoull(a[i + 1])) << 10;
+                } catch (...) {
+                    Tcl_SetObjResult(
+                      ip, Tcl_NewStringObj(("invalid " + a[i]).c_str(), -1));
+                    return TCL_ERROR;
+                }
+                ++i;
+            }
+        }
+        if (!store.configure(opts, &oss)) {
+            Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
+            return TCL_ERROR;
+        }
+        std::vector<hdl::elab::ModuleSpec*> specs;
+        for (auto& kv : c.specLib())
+            if (!kv.second.mAliasOf) specs.push_back(&kv.second);
+        for (auto* s : specs)
+            if (s->mBitMap.frozen()) s->mBitMap.freeze();
+        for (auto* s : specs)
+            if (s->mInstTable.built()) s->mInstTable.build(*s);
+        for (auto* s : specs)
+            if (s->mFanout.built()) s->mFanout.build(*s);
+        c.dropDerivedCaches();
+    }
+    auto st = store.stats();
+    oss << "spill " << (store.enabled() ? store.options().mDir : "off")
+        << " regions=" << st.mRegions << " mapped=" << st.mMappedBytes
+        << " resident=" << st.mResidentBytes
+        << " budget=" << store.options().mBudget << " faults=" << st.mFaults
+        << " evictions=" << st.mEvictions;
     Tcl_SetObjResult(ip, Tcl_NewStringObj(oss.str().c_str(), -1));
     return TCL_OK;
 }
@@ -47,6 +187,22 @@ void register_cmd_specs(Console& c) {
                       "List elaborated ModuleSpecs in library",
                       &cmd_specs,
                       &compl_specs);
+    c.registerCommand("merge-specs",
+                      "Merge structurally identical specializations into "
+                      "alias entries: merge-specs [-v]",
+                      &cmd_merge_specs);
+    c.registerCommand("load-cells",
+                      "Load a primitive cell library and relink: "
+                      "load-cells <file>",
+                      &cmd_load_cells);
+    c.registerCommand("prune-wires",
+                      "Remove unreferenced wires: prune-wires [specKey]",
+                      &cmd_prune_wires,
+                      &compl_specs);
+    c.registerCommand("spill",
+                      "Spill frozen connection arrays to mapped scratch "
+                      "files: spill [-dir D] [-budget MB] [-min KB] | off",
+                      &cmd_spill);
     // Usability aliases
     c.registerCommand(
       "list-modules", "Alias: modules", &cmd_modules, &compl_modules);
@@ -14,6 +14,9 @@ void register_all_commands(Console& c) {
     register_cmd_query(c);
     register_cmd_undo(c);
     register_cmd_history(c);
+    register_cmd_hier(c);
+    register_cmd_pins(c);
+    register_cmd_lint(c);
     // Hook for user-provided commands (see src/tcl/cmd/user/)
     register_user_commands(c);
 }
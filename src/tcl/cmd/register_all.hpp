@@ -14,9 +14,14 @@ void register_cmd_selection(Console& c); // selection show/summary/clear
 void register_cmd_ports(Console& c);   // select-port/unselect-port/list-ports
 void register_cmd_wires(Console& c);   // select-wire/unselect-wire/list-wires
 void register_cmd_dump(Console& c);    // dump-layout/connectivity/hierarchy
-void register_cmd_query(Console& c);   // net-of/render-bit
+void register_cmd_query(Console& c);   // net-of/render-bit/fanout/fanin
 void register_cmd_undo(Console& c);    // undo/redo
 void register_cmd_history(Console& c); // history
+// flatten-design/stats/list-instances/where-used
+void register_cmd_hier(Console& c);
+// resolve-pin/select-pin/unselect-pin/trace-cone
+void register_cmd_pins(Console& c);
+void register_cmd_lint(Console& c); // lint/constants
 
 void register_all_commands(Console& c);
 // external user commands (stubbed by default; see src/tcl/cmd/user/)
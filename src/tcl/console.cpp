@@ -286,12 +286,18 @@ Console::completeCommandNames(const std::string& prefix) const {
 }
 
 // Public helpers
+// Quoted as a Tcl list, so args such as "m1/u0.a[1]" replay verbatim
+// instead of being command-substituted.
 std::string Console::makeCmdLine(const std::string& sub, const Args& args) {
-    std::ostringstream oss;
-    oss << sub;
-    for (size_t i = 0; i < args.size(); ++i)
-        oss << ' ' << args[i];
-    return oss.str();
+    std::vector<const char*> argv;
+    argv.reserve(args.size() + 1);
+    argv.push_back(sub.c_str());
+    for (const auto& a : args)
+        argv.push_back(a.c_str());
+    char* merged = Tcl_Merge(static_cast<int>(argv.size()), argv.data());
+    std::string line(merged);
+    Tcl_Free(merged);
+    return line;
 }
 
 elab::ParamSpec Console::parseParamTokens(const std::vector<std::string>& toks,
@@ -383,6 +389,7 @@ Console::completeParams(const std::string& moduleName,
 elab::ModuleSpec* Console::getSpecByKey(std::string key) {
     auto it = mSpecLib.find(IdString(key, IdString::NoIntern));
     if (it == mSpecLib.end()) return nullptr;
+    if (it->second.mAliasOf) return it->second.mAliasOf;
     return &it->second;
 }
 elab::ModuleSpec* Console::getOrElabByName(std::string name,
@@ -391,7 +398,8 @@ elab::ModuleSpec* Console::getOrElabByName(std::string name,
     auto it = mDeclLib.find(IdString(name, IdString::NoIntern));
     if (it == mDeclLib.end()) return nullptr;
     elab::ModuleSpec& s = elab::getOrCreateSpec(it->second, env, mSpecLib);
-    elab::linkInstances(s, mDeclLib, mSpecLib, &mDiag);
+    elab::linkHierarchy(s, mDeclLib, mSpecLib, &mDiag, &mCells);
+    dropDerivedCaches();
     IdString key(elab::makeModuleKey(name, env));
     if (outKey) *outKey = key;
     return &s;
@@ -400,6 +408,19 @@ elab::ModuleSpec* Console::currentPrimarySpec() {
     if (!mSel.mPrimaryKey.valid()) return nullptr;
     return getSpecByKey(mSel.mPrimaryKey.str());
 }
+void Console::dropDerivedCaches() {
+    mPathResolvers.clear();
+    mPortModels = elab::hier::PortModelCache{};
+}
+elab::hier::PathResolver* Console::pathResolver(IdString key) {
+    if (auto it = mPathResolvers.find(key); it != mPathResolvers.end())
+        return it->second.get();
+    auto* s = getSpecByKey(key.str());
+    if (!s) return nullptr;
+    auto& r = mPathResolvers[key];
+    r = std::make_unique<elab::hier::PathResolver>(*s, &mDiag);
+    return r.get();
+}
 bool Console::resolvePortName(const elab::ModuleSpec& spec,
                               const std::string& tok, IdString& out) const {
     bool num = !tok.empty() && std::all_of(tok.begin(), tok.end(), ::isdigit);
@@ -436,6 +457,7 @@ bool Console::resolveWireName(const elab::ModuleSpec& spec,
         out = n;
         return true;
     }
+    if (spec.isPrunedWire(n)) warn("wire " + tok + " was pruned");
     return false;
 }
 
@@ -0,0 +1,162 @@
+#include "hdl/util/spill.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "hdl/common.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HDL_HAVE_MMAP 1
+#endif
+
+namespace hdl {
+
+SpillRegion::SpillRegion(SpillStore& store, void* addr, size_t bytes)
+    : mStore(store)
+    , mClock(&store.mClock)
+    , mAddr(addr)
+    , mBytes(bytes) {}
+
+SpillRegion::~SpillRegion() {
+    mStore.remove(*this);
+#ifdef HDL_HAVE_MMAP
+    munmap(mAddr, mBytes);
+#endif
+}
+
+void SpillRegion::fault() {
+    std::lock_guard<std::mutex> lock(mStore.mMutex);
+    if (mResident.load(std::memory_order_relaxed)) return;
+    ++mStore.mFaults;
+    mStore.mClock.fetch_add(1, std::memory_order_relaxed);
+    mLastUse.store(mStore.mClock.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+    mStore.mResident += mBytes;
+    mResident.store(true, std::memory_order_release);
+    mStore.evictLocked(mStore.mOpts.mBudget, this);
+}
+
+SpillStore& SpillStore::global() {
+    static SpillStore store;
+    return store;
+}
+
+bool SpillStore::configure(const SpillOptions& opts, std::ostream* diag) {
+#ifdef HDL_HAVE_MMAP
+    if (!opts.mDir.empty()) {
+        struct stat st;
+        if (stat(opts.mDir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            error(diag, "spill directory " + opts.mDir + " does not exist");
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOpts = opts;
+    mEnabled.store(!opts.mDir.empty(), std::memory_order_relaxed);
+    evictLocked(mOpts.mBudget, nullptr);
+    return true;
+#else
+    if (opts.mDir.empty()) return true;
+    error(diag, "spilling needs mmap, which this platform lacks");
+    return false;
+#endif
+}
+
+std::shared_ptr<SpillRegion> SpillStore::spill(const void* data, size_t bytes,
+                                               std::ostream* diag) {
+#ifdef HDL_HAVE_MMAP
+    std::string path = mOpts.mDir + "/hdl-spill-XXXXXX";
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        error(diag, "cannot create spill file in " + mOpts.mDir);
+        return nullptr;
+    }
+    unlink(path.c_str()); // lives until unmapped
+    const char* p = static_cast<const char*>(data);
+    for (size_t left = bytes; left;) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            error(diag, std::string("spill write failed: ") +
+                          std::strerror(errno));
+            close(fd);
+            return nullptr;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    void* addr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        error(diag, std::string("spill mmap failed: ") + std::strerror(errno));
+        return nullptr;
+    }
+    std::shared_ptr<SpillRegion> r(new SpillRegion(*this, addr, bytes));
+    admit(*r);
+    return r;
+#else
+    (void)data;
+    (void)bytes;
+    (void)diag;
+    return nullptr;
+#endif
+}
+
+void SpillStore::admit(SpillRegion& r) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRegions.push_back(&r);
+    r.mLastUse.store(mClock.fetch_add(1, std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+    mResident += r.mBytes;
+    evictLocked(mOpts.mBudget, &r);
+}
+
+void SpillStore::evictLocked(size_t budget, const SpillRegion* keep) {
+    while (mResident > budget) {
+        SpillRegion* lru = nullptr;
+        for (SpillRegion* r : mRegions) {
+            if (r == keep || !r->mResident.load(std::memory_order_relaxed))
+                continue;
+            if (!lru || r->mLastUse.load(std::memory_order_relaxed) <
+                          lru->mLastUse.load(std::memory_order_relaxed))
+                lru = r;
+        }
+        if (!lru) return;
+#ifdef HDL_HAVE_MMAP
+        madvise(lru->mAddr, lru->mBytes, MADV_DONTNEED);
+#endif
+        lru->mResident.store(false, std::memory_order_release);
+        mResident -= lru->mBytes;
+        ++mEvictions;
+    }
+}
+
+void SpillStore::remove(SpillRegion& r) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::erase(mRegions, &r);
+    if (r.mResident.load(std::memory_order_relaxed)) mResident -= r.mBytes;
+}
+
+void SpillStore::trim() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    evictLocked(mOpts.mBudget, nullptr);
+}
+
+SpillStats SpillStore::stats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    SpillStats s;
+    s.mRegions = mRegions.size();
+    for (const SpillRegion* r : mRegions)
+        s.mMappedBytes += r->mBytes;
+    s.mResidentBytes = mResident;
+    s.mFaults = mFaults;
+    s.mEvictions = mEvictions;
+    return s;
+}
+
+} // namespace hdl
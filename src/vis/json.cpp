@@ -39,6 +39,22 @@ static void buildNodes(const elab::ModuleSpec& spec, json& outNodes) {
                             {"msb", p.mNet.mMsb},
                             {"lsb", p.mNet.mLsb}});
     }
+    // Tie-offs, only when some binding uses a constant
+    bool tie[2] = {false, false};
+    for (const auto& inst : spec.mInstances) {
+        for (const auto& c : inst.mConns) {
+            for (const auto& a : c.mActual) {
+                if (a.mKind == elab::BitAtomKind::Const0) tie[0] = true;
+                if (a.mKind == elab::BitAtomKind::Const1) tie[1] = true;
+            }
+        }
+    }
+    for (int v = 0; v < 2; ++v) {
+        if (!tie[v]) continue;
+        std::string id = v ? "1'b1" : "1'b0";
+        outNodes.push_back(
+          {{"id", id}, {"type", "tie"}, {"name", id}, {"value", v}});
+    }
     // Instances
     for (const auto& inst : spec.mInstances) {
         json jinst = {
@@ -82,7 +98,10 @@ segmentsForBinding(const elab::ModuleSpec& spec,
     const int Wf = bitWidth(formal);
     (void)Wf;
 
+    // Constants come from the tie nodes (see buildNodes).
     auto ownerName = [&](const elab::BitAtom& a) -> std::string {
+        if (a.mKind == elab::BitAtomKind::Const0) return "1'b0";
+        if (a.mKind == elab::BitAtomKind::Const1) return "1'b1";
         return a.mOwnerIndex.valid() ? a.mOwnerIndex.str()
                                      : std::string("<unknown>");
     };
@@ -90,13 +109,6 @@ segmentsForBinding(const elab::ModuleSpec& spec,
     int i = 0;
     while (i < static_cast<int>(actual.size())) {
         const auto& a0 = actual[i];
-        if (!(a0.mKind == elab::BitAtomKind::WireBit ||
-              a0.mKind == elab::BitAtomKind::PortBit)) {
-            // Skip constants (demo); in production, make a special segment
-            // (Const)
-            ++i;
-            continue;
-        }
         Segment s;
         s.mOwnerId = ownerName(a0);
         s.mKind = a0.mKind;
@@ -108,8 +120,11 @@ segmentsForBinding(const elab::ModuleSpec& spec,
             if (ax.mKind != s.mKind) break;
             if (ownerName(ax) != s.mOwnerId) break;
             const int toBit = j; // formal bit offset
-            const int fromBit =
-              static_cast<int>(ax.mBitIndex); // actual bit in owner
+            const bool isConst = ax.mKind == elab::BitAtomKind::Const0 ||
+                                 ax.mKind == elab::BitAtomKind::Const1;
+            const int fromBit = isConst ? 0
+                                        : static_cast<int>(
+                                            ax.mBitIndex); // bit in owner
             s.mMapping.emplace_back(fromBit, toBit);
         }
         segs.push_back(std::move(s));
@@ -1,13 +1,35 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
 #include <type_traits>
 
 #include <gtest/gtest.h>
 
 #include "hdl/ast/decl.hpp"
 #include "hdl/ast/expr.hpp"
+#include "hdl/elab/cells.hpp"
 #include "hdl/elab/elaborate.hpp"
+#include "hdl/elab/fingerprint.hpp"
 #include "hdl/elab/flatten.hpp"
+#include "hdl/elab/lint.hpp"
+#include "hdl/elab/prune.hpp"
 #include "hdl/elab/spec.hpp"
+#include "hdl/hier/cone.hpp"
+#include "hdl/hier/const_prop.hpp"
+#include "hdl/hier/flat_graph.hpp"
+#include "hdl/hier/global_net.hpp"
+#include "hdl/hier/loops.hpp"
+#include "hdl/hier/path.hpp"
+#include "hdl/hier/port_model.hpp"
+#include "hdl/hier/rollup.hpp"
+#include "hdl/hier/walk.hpp"
+#include "hdl/hier/where_used.hpp"
+#include "hdl/net/packed_bits.hpp"
+#include "hdl/tcl/console.hpp"
 #include "hdl/util/id_string.hpp"
+#include "hdl/util/spill.hpp"
 
 using namespace hdl;
 using namespace hdl::ast;
@@ -98,6 +120,26 @@ TEST(BitMap, AllocationAndReverse) {
     // Reverse render
     EXPECT_EQ(spec.renderBit(0), "port " + p.str() + "[0]");
     EXPECT_EQ(spec.renderBit(13), "wire " + w.str() + "[7]");
+
+    // Range-table lookups at owner boundaries
+    net::BitOwnerRef r;
+    ASSERT_TRUE(spec.mBitMap.ownerOf(4, r));
+    EXPECT_EQ(r.mKind, net::BitOwnerRef::Kind::Port);
+    EXPECT_EQ(r.mOwnerIndex, 1u);
+    EXPECT_EQ(r.mBitOffset, 0u);
+    ASSERT_TRUE(spec.mBitMap.ownerOf(5, r));
+    EXPECT_EQ(r.mBitOffset, 1u);
+    ASSERT_TRUE(spec.mBitMap.ownerOf(6, r));
+    EXPECT_EQ(r.mKind, net::BitOwnerRef::Kind::Wire);
+    EXPECT_EQ(r.mOwnerIndex, 0u);
+    // Tie-0/tie-1 follow the wires.
+    EXPECT_EQ(spec.mBitMap.tieBit(false), 14u);
+    ASSERT_TRUE(spec.mBitMap.ownerOf(15, r));
+    EXPECT_EQ(r.mKind, net::BitOwnerRef::Kind::Tie);
+    EXPECT_EQ(r.mOwnerIndex, 1u);
+    EXPECT_EQ(spec.renderBit(15), "1'b1");
+    EXPECT_FALSE(spec.mBitMap.ownerOf(16, r));
+    EXPECT_EQ(spec.mBitMap.mOwnerRanges.size(), 5u);
 }
 
 TEST(Connectivity, AliasAndNetId) {
@@ -120,6 +162,264 @@ TEST(Connectivity, AliasAndNetId) {
               spec.mBitMap.netId(spec.mBitMap.wireBit(0, 1)));
 }
 
+TEST(Connectivity, ConcurrentMatchesSequential) {
+    const net::BitId N = 4096;
+    std::vector<std::pair<net::BitId, net::BitId>> pairs;
+    for (net::BitId i = 0; i < N / 2; ++i)
+        pairs.emplace_back((i * 7919u) % N, (i * 104729u + 3) % N);
+
+    net::Connectivity seq;
+    seq.allocRange(N);
+    for (auto& [a, b] : pairs)
+        seq.alias(a, b);
+
+    net::Connectivity conc(net::UnionFindMode::Concurrent);
+    conc.allocRange(N);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < 8; ++t) {
+        pool.emplace_back([&, t] {
+            for (size_t i = t; i < pairs.size(); i += 8)
+                conc.alias(pairs[i].first, pairs[i].second);
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+
+    for (auto& [a, b] : pairs)
+        EXPECT_EQ(conc.netId(a), conc.netId(b));
+    // Label every bit by the smallest member of its net; equal labels for
+    // all bits means the two partitions are identical.
+    seq.freeze();
+    conc.freeze();
+    auto smallestMember = [](const net::Connectivity& c, net::BitId i) {
+        return c.bitsOf(c.netOf(i))[0];
+    };
+    ASSERT_EQ(conc.netCount(), seq.netCount());
+    for (net::BitId i = 0; i < N; ++i)
+        ASSERT_EQ(smallestMember(conc, i), smallestMember(seq, i))
+          << "bit " << i;
+
+    // Switching modes keeps the partition.
+    conc.setMode(net::UnionFindMode::Sequential);
+    for (auto& [a, b] : pairs)
+        EXPECT_EQ(conc.netId(a), conc.netId(b));
+}
+
+TEST(Connectivity, ConcurrentFreezeAroundAlias) {
+    const net::BitId N = 2048;
+    std::vector<std::pair<net::BitId, net::BitId>> pairs;
+    for (net::BitId i = 0; i < N / 2; ++i)
+        pairs.emplace_back((i * 7919u) % N, (i * 104729u + 3) % N);
+    const size_t half = pairs.size() / 2;
+
+    net::Connectivity seq;
+    seq.allocRange(N);
+    for (auto& [a, b] : pairs)
+        seq.alias(a, b);
+    seq.freeze();
+
+    net::Connectivity conc(net::UnionFindMode::Concurrent);
+    conc.allocRange(N);
+    auto parallelAlias = [&](size_t lo, size_t hi) {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < 4; ++t) {
+            pool.emplace_back([&, t] {
+                for (size_t i = lo + t; i < hi; i += 4)
+                    conc.alias(pairs[i].first, pairs[i].second);
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+    };
+    parallelAlias(0, half);
+    conc.freeze();
+    ASSERT_TRUE(conc.frozen());
+    for (size_t i = 0; i < half; ++i)
+        EXPECT_EQ(conc.netOf(pairs[i].first), conc.netOf(pairs[i].second));
+
+    conc.beginConcurrent();
+    EXPECT_FALSE(conc.frozen());
+    parallelAlias(half, pairs.size());
+    EXPECT_FALSE(conc.frozen());
+    conc.freeze();
+    // Canonical numbering: equal NetIds per bit means equal partitions.
+    ASSERT_EQ(conc.netCount(), seq.netCount());
+    for (net::BitId i = 0; i < N; ++i)
+        ASSERT_EQ(conc.netOf(i), seq.netOf(i)) << "bit " << i;
+}
+
+TEST(Connectivity, FreezeDenseNetIds) {
+    net::Connectivity conn;
+    conn.allocRange(6);
+    conn.alias(5, 1);
+    conn.alias(3, 5);
+    conn.freeze();
+    ASSERT_TRUE(conn.frozen());
+
+    // Nets numbered by smallest member: {0} {1,3,5} {2} {4}
+    EXPECT_EQ(conn.netCount(), 4u);
+    EXPECT_EQ(conn.netOf(0), 0u);
+    EXPECT_EQ(conn.netOf(1), 1u);
+    EXPECT_EQ(conn.netOf(3), 1u);
+    EXPECT_EQ(conn.netOf(5), 1u);
+    EXPECT_EQ(conn.netOf(2), 2u);
+    EXPECT_EQ(conn.netOf(4), 3u);
+
+    const auto& off = conn.netOffsets();
+    const auto& bits = conn.netBits();
+    ASSERT_EQ(off.size(), 5u);
+    EXPECT_EQ(off[1] - off[0], 1u);
+    EXPECT_EQ(off[2] - off[1], 3u);
+    EXPECT_EQ(bits[off[1]], 1u);
+    EXPECT_EQ(bits[off[1] + 1], 3u);
+    EXPECT_EQ(bits[off[1] + 2], 5u);
+
+    // alias() invalidates; netId() refreezes on demand.
+    conn.alias(0, 4);
+    EXPECT_FALSE(conn.frozen());
+    EXPECT_EQ(conn.netId(4), 0u);
+    EXPECT_EQ(conn.netCount(), 3u);
+}
+
+TEST(Connectivity, NetGroupsIteration) {
+    net::Connectivity conn;
+    conn.allocRange(5);
+    conn.alias(4, 0);
+    conn.alias(2, 3);
+
+    std::vector<std::vector<net::BitId>> seen;
+    for (auto bits : conn.groups())
+        seen.emplace_back(bits.begin(), bits.end());
+    ASSERT_EQ(seen.size(), 3u);
+    EXPECT_EQ(seen[0], (std::vector<net::BitId>{0, 4}));
+    EXPECT_EQ(seen[1], (std::vector<net::BitId>{1}));
+    EXPECT_EQ(seen[2], (std::vector<net::BitId>{2, 3}));
+    EXPECT_EQ(conn.bitsOf(conn.netOf(3)).size(), 2u);
+}
+
+TEST(Connectivity, SparseImplicitSingletons) {
+    net::Connectivity conn;
+    net::BitId mem = conn.allocRange(1u << 20); // untouched memory array
+    net::BitId bus = conn.allocRange(64);
+    EXPECT_EQ(conn.mUf.pageCount(), 0u);
+    EXPECT_LT(conn.memoryBytes(), 1024u);
+
+    conn.alias(bus, bus + 63);
+    conn.alias(mem + 5, bus + 63);
+    EXPECT_EQ(conn.mUf.pageCount(), 2u);
+    EXPECT_EQ(conn.netId(mem + 5), conn.netId(bus));
+    EXPECT_NE(conn.netId(mem + 6), conn.netId(bus));
+    EXPECT_EQ(conn.netCount(), (1u << 20) + 64 - 2);
+}
+
+TEST(PackedBits, RoundTrip) {
+    using PB = net::PackedBitArray;
+    std::vector<net::BitId> v;
+    for (net::BitId b = 100; b < 164; ++b) // two run blocks
+        v.push_back(b);
+    for (int k = 0; k < 32; ++k) // reversed bus
+        v.push_back(500 - k);
+    for (int k = 0; k < 32; ++k) // local ids, a clock and an open pin
+        v.push_back(k == 5 ? 3 : k == 9 ? UINT32_MAX : 9000 + (k * 7) % 40);
+    for (int k = 0; k < 32; ++k) // drifting ids with one far jump
+        v.push_back(k == 20 ? 70000 : 20000 + 13 * k);
+    std::mt19937 rng(1);
+    for (int k = 0; k < 45; ++k) // random, partial last block
+        v.push_back(rng());
+
+    PB p(v);
+    ASSERT_EQ(p.size(), v.size());
+    ASSERT_EQ(p.blockCount(), 7u);
+    EXPECT_EQ(p.mode(0), PB::Mode::Stride);
+    EXPECT_EQ(p.mode(2), PB::Mode::Stride);
+    EXPECT_EQ(p.mode(3), PB::Mode::For8);
+    EXPECT_EQ(p.mode(4), PB::Mode::Delta8);
+    EXPECT_EQ(p.mode(5), PB::Mode::Raw);
+
+    for (size_t i = 0; i < v.size(); ++i)
+        ASSERT_EQ(p[i], v[i]) << i;
+    std::vector<net::BitId> out;
+    for (net::BitId b : p)
+        out.push_back(b);
+    EXPECT_EQ(out, v);
+    std::vector<net::BitId> mid(70);
+    p.decode(50, mid.size(), mid.data());
+    EXPECT_TRUE(std::equal(mid.begin(), mid.end(), v.begin() + 50));
+
+    std::vector<net::BitId> bus(1 << 12);
+    std::iota(bus.begin(), bus.end(), 77u);
+    EXPECT_LT(PB(bus).memoryBytes() * 8, bus.size() * sizeof(net::BitId));
+}
+
+TEST(Spill, MappedArrays) {
+    auto& store = hdl::SpillStore::global();
+    hdl::SpillOptions opts;
+    opts.mDir = ::testing::TempDir();
+    opts.mBudget = 40 << 10;
+    opts.mMinBytes = 0;
+    ASSERT_TRUE(store.configure(opts));
+
+    // Five 16 KiB arrays under a 40 KiB budget.
+    std::vector<std::vector<uint32_t>> src(5);
+    std::vector<hdl::FrozenArray<uint32_t>> arrs;
+    for (uint32_t a = 0; a < src.size(); ++a) {
+        src[a].resize(4096);
+        std::iota(src[a].begin(), src[a].end(), a * 7919);
+        arrs.emplace_back(std::vector<uint32_t>(src[a]));
+        EXPECT_TRUE(arrs.back().spilled());
+        EXPECT_EQ(arrs.back().memoryBytes(), 0u);
+    }
+    for (int round = 0; round < 2; ++round)
+        for (uint32_t a = 0; a < src.size(); ++a)
+            EXPECT_TRUE(std::equal(
+              arrs[a].begin(), arrs[a].end(), src[a].begin(), src[a].end()));
+    auto st = store.stats();
+    EXPECT_EQ(st.mRegions, 5u);
+    EXPECT_EQ(st.mMappedBytes, 5u * 4096 * sizeof(uint32_t));
+    EXPECT_LE(st.mResidentBytes, opts.mBudget);
+    EXPECT_GT(st.mEvictions, 0u);
+    EXPECT_GT(st.mFaults, 0u);
+
+    // Frozen connectivity reads the same through a mapped region.
+    hdl::net::Connectivity conn;
+    conn.allocRange(6);
+    conn.alias(5, 1);
+    conn.alias(3, 5);
+    conn.freeze();
+    EXPECT_TRUE(conn.netOfArray().spilled());
+    EXPECT_EQ(conn.netCount(), 4u);
+    EXPECT_EQ(conn.netOf(5), 1u);
+    EXPECT_EQ(conn.bitsOf(1).size(), 3u);
+    EXPECT_EQ(conn.bitsOf(1)[2], 5u);
+    // The spilled index is the only copy of the partition; aliasing again
+    // rebuilds the union-find from it.
+    EXPECT_EQ(conn.mUf.pageCount(), 0u);
+    conn.alias(0, 4);
+    conn.freeze();
+    EXPECT_EQ(conn.netCount(), 3u);
+    EXPECT_EQ(conn.netOf(4), 0u);
+    EXPECT_EQ(conn.netOf(5), 1u);
+    EXPECT_EQ(conn.netOf(2), 2u);
+    // Concurrent mode keeps its parent array for the next parallel alias().
+    conn.setMode(net::UnionFindMode::Concurrent);
+    conn.freeze();
+    EXPECT_TRUE(conn.netOfArray().spilled());
+    EXPECT_EQ(conn.mCuf.mParent.size(), 6u);
+    conn.beginConcurrent();
+    std::thread th([&] { conn.alias(2, 3); });
+    th.join();
+    conn.freeze();
+    EXPECT_EQ(conn.netCount(), 2u);
+    EXPECT_EQ(conn.netOf(2), conn.netOf(5));
+    conn.setMode(net::UnionFindMode::Sequential);
+
+    arrs.clear();
+    EXPECT_EQ(store.stats().mRegions, 3u); // conn's three arrays
+    ASSERT_TRUE(store.configure(hdl::SpillOptions{}));
+    hdl::FrozenArray<uint32_t> mem(std::vector<uint32_t>(4096, 1));
+    EXPECT_FALSE(mem.spilled());
+}
+
 TEST(Flatten, IdSliceConcat) {
     IdString M("M");
     IdString x("x");
@@ -269,6 +569,1169 @@ TEST(Generate, IfAndFor) {
     EXPECT_EQ(b0.mActual.size(), 8u);
 }
 
+TEST(Elab, MergeEquivalentSpecs) {
+    IdString A("A"), B("B"), W("W"), X("X");
+    IdString a("a"), y("y"), i("i"), o("o"), u("u");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        // W and X do not affect structure.
+        ModuleDecl dA;
+        dA.mName = A;
+        dA.mDefaults.emplace(W, 1);
+        dA.mPorts.push_back(PortDecl{a, PortDirection::In, n(1, 0)});
+        dA.mPorts.push_back(PortDecl{y, PortDirection::Out, n(1, 0)});
+        dA.mAssigns.push_back(AssignDecl{BVExpr::id(y), BVExpr::id(a)});
+        ModuleDecl dB;
+        dB.mName = B;
+        dB.mDefaults.emplace(X, 1);
+        dB.mPorts.push_back(PortDecl{i, PortDirection::In, n(1, 0)});
+        dB.mPorts.push_back(PortDecl{o, PortDirection::Out, n(1, 0)});
+        dB.mInstances.push_back(
+          InstanceDecl{u,
+                       A,
+                       {{W, IntExpr::id(X)}},
+                       {ConnDecl{a, BVExpr::id(i)}, ConnDecl{y, BVExpr::id(o)}}});
+        declLib.emplace(A, std::move(dA));
+        declLib.emplace(B, std::move(dB));
+    }
+    ModuleSpec& b1 = getOrCreateSpec(declLib[B], {{X, 1}}, specLib);
+    linkHierarchy(b1, declLib, specLib, &std::cerr);
+    ModuleSpec& b2 = getOrCreateSpec(declLib[B], {{X, 2}}, specLib);
+    linkHierarchy(b2, declLib, specLib, &std::cerr);
+    ASSERT_EQ(specLib.size(), 4u);
+    EXPECT_NE(b1.mInstances[0].mCallee, b2.mInstances[0].mCallee);
+
+    SpecFingerprints fps;
+    fps[b1.mInstances[0].mCallee] =
+      structuralFingerprint(*b1.mInstances[0].mCallee, fps);
+    fps[b2.mInstances[0].mCallee] =
+      structuralFingerprint(*b2.mInstances[0].mCallee, fps);
+    EXPECT_EQ(fps[b1.mInstances[0].mCallee], fps[b2.mInstances[0].mCallee]);
+
+    auto st = mergeEquivalentSpecs(specLib);
+    EXPECT_EQ(st.mSpecs, 4u);
+    EXPECT_EQ(st.mMerged, 2u); // A#W=2 first, then B#X=2 through it
+    EXPECT_GT(st.reclaimed(), 0u);
+    EXPECT_EQ(specLib.size(), 4u);
+    ModuleSpec& bx2 = specLib[IdString("B#X=2")];
+    EXPECT_EQ(bx2.mAliasOf, &b1);
+    EXPECT_EQ(specLib[IdString("A#W=2")].mAliasOf, b1.mInstances[0].mCallee);
+    ASSERT_EQ(b1.mInstances[0].mCallee->mUsers.size(), 1u);
+
+    // Lookups and relinking go through the alias.
+    EXPECT_EQ(&getOrCreateSpec(declLib[B], {{X, 2}}, specLib), &b1);
+    linkHierarchy(b1, declLib, specLib, &std::cerr);
+    EXPECT_EQ(mergeEquivalentSpecs(specLib).mMerged, 0u);
+
+    // Merging a callee keeps the parent's instance table usable: the loop
+    // p -> A#W=1 -> q -> A#W=3 -> p survives, constants still run.
+    IdString T("MergeLoopTop"), p("p"), q("q");
+    {
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mWires.push_back(WireDecl{p, n(1, 0)});
+        dT.mWires.push_back(WireDecl{q, n(1, 0)});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("f0"),
+                       A,
+                       {{W, IntExpr::number(1)}},
+                       {ConnDecl{a, BVExpr::id(p)}, ConnDecl{y, BVExpr::id(q)}}});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("f1"),
+                       A,
+                       {{W, IntExpr::number(3)}},
+                       {ConnDecl{a, BVExpr::id(q)}, ConnDecl{y, BVExpr::id(p)}}});
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& lt = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(lt, declLib, specLib, &std::cerr);
+    auto loopCount = [&] {
+        hier::RollupTable rt(lt);
+        std::vector<hier::ModuleLoops> res;
+        EXPECT_TRUE(hier::findCombLoops(rt.order(), {}, res));
+        return res.back().mLoops.size();
+    };
+    EXPECT_EQ(loopCount(), 2u); // one per bus bit
+    EXPECT_EQ(mergeEquivalentSpecs(specLib).mMerged, 1u); // A#W=3
+    EXPECT_EQ(lt.mInstTable.callee(1), lt.mInstances[1].mCallee);
+    EXPECT_EQ(lt.mInstTable.callee(1)->mPorts.size(), 2u);
+    EXPECT_EQ(loopCount(), 2u); // one per bus bit
+    hier::ConstTable ct(lt);
+    EXPECT_EQ(ct.of(lt).mConflictNets, 0u);
+}
+
+TEST(Elab, Lint) {
+    IdString B("B"), T("LintTop");
+    IdString a("a"), y("y"), i("i"), o("o");
+    IdString u("u"), d("d"), m("m"), wide("wide");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dB; // black box
+        dB.mName = B;
+        dB.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dB.mPorts.push_back(PortDecl{y, PortDirection::Out, n(0, 0)});
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mPorts.push_back(PortDecl{i, PortDirection::In, n(0, 0)});
+        dT.mPorts.push_back(PortDecl{o, PortDirection::Out, n(1, 0)});
+        dT.mWires.push_back(WireDecl{u, n(1, 0)});
+        dT.mWires.push_back(WireDecl{d, n(0, 0)});
+        dT.mWires.push_back(WireDecl{m, n(0, 0)});
+        dT.mWires.push_back(WireDecl{wide, n(1, 0)});
+        // o[0] = i; o[1] floats.
+        dT.mAssigns.push_back(
+          AssignDecl{BVExpr::slice(o, 0, 0), BVExpr::id(i)});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("b0"), B, {}, {ConnDecl{a, BVExpr::id(d)}}});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("b1"), B, {}, {ConnDecl{y, BVExpr::id(m)}}});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("b2"), B, {}, {ConnDecl{y, BVExpr::id(m)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("b3"), B, {}, {ConnDecl{a, BVExpr::id(wide)}}});
+        declLib.emplace(B, std::move(dB));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    std::ostringstream diag;
+    linkHierarchy(top, declLib, specLib, &diag);
+    ASSERT_EQ(top.mWidthMismatches.size(), 1u);
+    EXPECT_EQ(top.mWidthMismatches[0].mExpected, 1u);
+    EXPECT_EQ(top.mWidthMismatches[0].mActual, 2u);
+
+    hier::RollupTable rt(top);
+    LintTable t = runLint(rt.order(), 2);
+    EXPECT_EQ(t.count(LintKind::Undriven), 1u);
+    EXPECT_EQ(t.count(LintKind::MultiDriven), 1u);
+    EXPECT_EQ(t.count(LintKind::FloatingOutput), 1u); // not B's y
+    // wide only feeds the rejected binding.
+    EXPECT_EQ(t.count(LintKind::UnusedWire), 2u);
+    EXPECT_EQ(t.count(LintKind::WidthMismatch), 1u);
+    EXPECT_EQ(t.size(), 6u);
+
+    auto und = t.select(LintKind::Undriven);
+    ASSERT_EQ(und.size(), 1u);
+    EXPECT_EQ(LintTable::describe(*und[0]), "wire d[0]");
+    EXPECT_EQ(LintTable::describe(*t.select(LintKind::MultiDriven)[0]),
+              "wire m[0] drivers=2");
+    EXPECT_EQ(LintTable::describe(*t.select(LintKind::FloatingOutput)[0]),
+              "port o[1]");
+    EXPECT_EQ(LintTable::describe(*t.select(LintKind::WidthMismatch)[0]),
+              "b3.a expected=1 actual=2");
+    LintKind k;
+    EXPECT_TRUE(parseLintKind("unused-wire", k));
+    EXPECT_EQ(k, LintKind::UnusedWire);
+}
+
+TEST(Elab, PruneDeadWires) {
+    IdString B("B"), T("PruneTop");
+    IdString a("a"), y("y"), i("i"), o("o");
+    IdString w("w"), dead("dead"), b("b"), dead2("dead2");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dB;
+        dB.mName = B;
+        dB.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dB.mPorts.push_back(PortDecl{y, PortDirection::Out, n(0, 0)});
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mPorts.push_back(PortDecl{i, PortDirection::In, n(0, 0)});
+        dT.mPorts.push_back(PortDecl{o, PortDirection::Out, n(1, 0)});
+        dT.mWires.push_back(WireDecl{w, n(0, 0)});
+        dT.mWires.push_back(WireDecl{dead, n(7, 0)});
+        dT.mWires.push_back(WireDecl{b, n(0, 0)});
+        dT.mWires.push_back(WireDecl{dead2, n(0, 0)});
+        // w = i; o = {b, w}; b0.a = w, b0.y = b; dead/dead2 unreferenced.
+        dT.mAssigns.push_back(AssignDecl{BVExpr::id(w), BVExpr::id(i)});
+        dT.mAssigns.push_back(
+          AssignDecl{BVExpr::slice(o, 0, 0), BVExpr::id(w)});
+        dT.mAssigns.push_back(
+          AssignDecl{BVExpr::slice(o, 1, 1), BVExpr::id(b)});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("b0"),
+                       B,
+                       {},
+                       {ConnDecl{a, BVExpr::id(w)}, ConnDecl{y, BVExpr::id(b)}}});
+        declLib.emplace(B, std::move(dB));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    std::ostringstream diag;
+    linkHierarchy(top, declLib, specLib, &diag);
+    net::NetId netsBefore = top.mBitMap.netCount();
+
+    PruneStats st = pruneDeadWires(top);
+    EXPECT_EQ(st.mWires, 2u);
+    EXPECT_EQ(st.mBits, 9u);
+    EXPECT_GT(st.saved(), 0u);
+    EXPECT_EQ(top.mBitMap.netCount(), netsBefore - 9);
+
+    ASSERT_EQ(top.mWires.size(), 2u);
+    EXPECT_EQ(top.wireBit(dead, 0), UINT32_MAX);
+    EXPECT_TRUE(top.isPrunedWire(dead));
+    EXPECT_TRUE(top.isPrunedWire(dead2));
+    EXPECT_FALSE(top.isPrunedWire(b));
+    std::vector<uint32_t> remap{0, ModuleSpec::kPrunedWire, 1,
+                                ModuleSpec::kPrunedWire};
+    EXPECT_EQ(top.mWireRemap, remap);
+
+    // Ports keep their BitIds; the old partition survives the rebuild.
+    EXPECT_EQ(top.portBit(i, 0), 0u);
+    EXPECT_EQ(top.mBitMap.netOf(top.portBit(o, 0)),
+              top.mBitMap.netOf(top.wireBit(w, 0)));
+    EXPECT_EQ(top.mBitMap.netOf(top.portBit(i, 0)),
+              top.mBitMap.netOf(top.wireBit(w, 0)));
+    EXPECT_EQ(top.mBitMap.netOf(top.portBit(o, 1)),
+              top.mBitMap.netOf(top.wireBit(b, 0)));
+    net::NetId nb = top.mBitMap.netOf(top.wireBit(b, 0));
+    ASSERT_EQ(top.mFanout.drivers(nb).size(), 1u);
+    EXPECT_EQ(top.mFanout.drivers(nb)[0].mKind, EndpointKind::ChildPin);
+
+    // A second run is a no-op.
+    EXPECT_EQ(pruneDeadWires(top).mWires, 0u);
+}
+
+TEST(Elab, PrimitiveCells) {
+    CellLibrary cells;
+    std::istringstream lib("# two cells\n"
+                           "cell NAND2\n"
+                           "  pin A in\n  pin B in\n  pin Y out\n"
+                           "  arc A Y\n  arc B Y\n"
+                           "end\n"
+                           "cell DFF\n  pin D in\n  pin Q out\nend\n");
+    ASSERT_TRUE(cells.load(lib, nullptr));
+    ASSERT_EQ(cells.size(), 2u);
+    EXPECT_TRUE(cells.type(1).opaque());
+    std::istringstream bad("cell X\n  pin A sideways\nend\n");
+    std::ostringstream diag;
+    EXPECT_FALSE(cells.load(bad, &diag));
+    EXPECT_NE(diag.str().find("cells:2"), std::string::npos);
+
+    IdString T("CellTop"), NAND2("NAND2"), DFF("DFF");
+    IdString a("a"), b("b"), y("y"), n1("n1"), s("s"), q("q");
+    IdString A("A"), B("B"), Y("Y"), D("D"), Q("Q");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dT.mPorts.push_back(PortDecl{b, PortDirection::In, n(0, 0)});
+        dT.mPorts.push_back(PortDecl{y, PortDirection::Out, n(0, 0)});
+        dT.mWires.push_back(WireDecl{n1, n(0, 0)});
+        dT.mWires.push_back(WireDecl{s, n(0, 0)});
+        dT.mWires.push_back(WireDecl{q, n(0, 0)});
+        auto cell = [&](const char* name, IdString type,
+                        std::vector<ConnDecl> conns) {
+            dT.mInstances.push_back(
+              InstanceDecl{IdString(name), type, {}, std::move(conns)});
+        };
+        cell("u0", NAND2, {{A, BVExpr::id(a)}, {B, BVExpr::id(b)},
+                           {Y, BVExpr::id(n1)}});
+        cell("u1", NAND2, {{A, BVExpr::id(n1)}, {B, BVExpr::number(1, 1)},
+                           {Y, BVExpr::id(y)}});
+        // s = !(s & q): a loop; q comes through a register.
+        cell("u2", NAND2, {{A, BVExpr::id(s)}, {B, BVExpr::id(q)},
+                           {Y, BVExpr::id(s)}});
+        cell("r0", DFF, {{D, BVExpr::id(s)}, {Q, BVExpr::id(q)}});
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(top, declLib, specLib, &std::cerr, &cells);
+    EXPECT_TRUE(top.mInstances.empty());
+    EXPECT_EQ(specLib.size(), 1u);
+    const PrimTable& pt = top.mPrims;
+    ASSERT_EQ(pt.size(), 4u);
+    EXPECT_EQ(pt.mNames[3], IdString("r0"));
+    EXPECT_EQ(pt.type(3).mName, DFF);
+    ASSERT_EQ(pt.pins(1).size(), 3u);
+    EXPECT_EQ(pt.pins(1)[1], top.mBitMap.tieBit(true));
+    EXPECT_LT(pt.memoryBytes() / pt.size(), 40u);
+
+    // u0.Y drives n1, which u1.A reads.
+    net::NetId nn = top.mBitMap.netOf(top.wireBit(n1, 0));
+    ASSERT_EQ(top.mFanout.drivers(nn).size(), 1u);
+    EXPECT_EQ(top.mFanout.drivers(nn)[0].mKind, EndpointKind::Cell);
+    EXPECT_EQ(top.mFanout.drivers(nn)[0].mIndex, 0u);
+    EXPECT_EQ(top.mFanout.loads(nn)[0].mPort, 0u);
+
+    hier::RollupTable rt(top);
+    EXPECT_EQ(rt.of(top).mLeafInstances, 4u);
+    EXPECT_EQ(rt.of(top).mLeafPins, 11u);
+    LintTable lt = runLint(rt.order(), 1);
+    EXPECT_EQ(lt.size(), 0u);
+    std::ostringstream dump;
+    hier::dumpInstanceTree(top, dump, {});
+    EXPECT_NE(dump.str().find("Cells (4):"), std::string::npos);
+    EXPECT_NE(dump.str().find("[3] r0 : DFF"), std::string::npos);
+
+    // a reaches y through both NAND arcs: two levels.
+    hier::ScopeTable st(top);
+    hier::ConeResult r;
+    ASSERT_TRUE(
+      hier::traceCone(st, hier::kRootScope, top.portBit(a, 0), {}, r));
+    EXPECT_EQ(r.mLevels, 2u);
+    EXPECT_EQ(r.mNets.back().mNet, top.mBitMap.netOf(top.portBit(y, 0)));
+
+    std::vector<hier::ModuleLoops> loops;
+    ASSERT_TRUE(hier::findCombLoops(rt.order(), {}, loops));
+    ASSERT_EQ(loops.back().mLoops.size(), 1u);
+    EXPECT_EQ(loops.back().mLoops[0],
+              std::vector<net::BitId>{top.wireBit(s, 0)});
+
+    // Cell arcs survive the cut-opaque models used by loops: p -> q by an
+    // assign, q -> p through a gate-level child.
+    IdString G("GateChild"), LT("GateLoopTop"), i("i"), o("o"), p("p");
+    {
+        ModuleDecl dG;
+        dG.mName = G;
+        dG.mPorts.push_back(PortDecl{i, PortDirection::In, n(0, 0)});
+        dG.mPorts.push_back(PortDecl{o, PortDirection::Out, n(0, 0)});
+        dG.mInstances.push_back(InstanceDecl{
+          IdString("g"),
+          NAND2,
+          {},
+          {{A, BVExpr::id(i)}, {B, BVExpr::number(1, 1)}, {Y, BVExpr::id(o)}}});
+        ModuleDecl dL;
+        dL.mName = LT;
+        dL.mWires.push_back(WireDecl{p, n(0, 0)});
+        dL.mWires.push_back(WireDecl{q, n(0, 0)});
+        dL.mAssigns.push_back(AssignDecl{BVExpr::id(q), BVExpr::id(p)});
+        dL.mInstances.push_back(InstanceDecl{
+          IdString("c0"), G, {}, {{i, BVExpr::id(q)}, {o, BVExpr::id(p)}}});
+        declLib.emplace(G, std::move(dG));
+        declLib.emplace(LT, std::move(dL));
+    }
+    ModuleSpec& lt2 = getOrCreateSpec(declLib[LT], {}, specLib);
+    linkHierarchy(lt2, declLib, specLib, &std::cerr, &cells);
+    hier::PortModelCache cut(/*cutOpaque=*/true);
+    EXPECT_EQ(cut.model(*lt2.mInstances[0].mCallee).arcCount(), 1u);
+    hier::RollupTable rt2(lt2);
+    ASSERT_TRUE(hier::findCombLoops(rt2.order(), {}, loops));
+    ASSERT_EQ(loops.back().mLoops.size(), 1u);
+    EXPECT_EQ(loops.back().mLoops[0].size(), 2u);
+}
+
+// Three-level design shared by the hierarchy tests:
+//   L  : a -> y feedthrough (2 bits)
+//   N  : a, b with no internal connection (1 bit)
+//   M  : i -> L u0 -> t -> L u1 -> o
+//   Top: w0 -> M m0 -> w1 -> M m1 -> w2; L x0 (a=w2, y open);
+//        N n0 (a=w0[0], b=w3[0]); L x1 (a open, y=w3)
+struct HierFixture {
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    ModuleSpec* top = nullptr;
+    ModuleSpec* mid = nullptr;
+
+    HierFixture() {
+        IdString L("L"), N("N"), M("M"), T("Top");
+        IdString a("a"), b("b"), y("y"), i("i"), o("o"), t("t");
+        IdString w0("w0"), w1("w1"), w2("w2"), w3("w3");
+
+        ModuleDecl dL;
+        dL.mName = L;
+        dL.mPorts.push_back(PortDecl{a, PortDirection::In, n(1, 0)});
+        dL.mPorts.push_back(PortDecl{y, PortDirection::Out, n(1, 0)});
+        dL.mAssigns.push_back(AssignDecl{BVExpr::id(y), BVExpr::id(a)});
+
+        ModuleDecl dN;
+        dN.mName = N;
+        dN.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dN.mPorts.push_back(PortDecl{b, PortDirection::Out, n(0, 0)});
+
+        ModuleDecl dM;
+        dM.mName = M;
+        dM.mPorts.push_back(PortDecl{i, PortDirection::In, n(1, 0)});
+        dM.mPorts.push_back(PortDecl{o, PortDirection::Out, n(1, 0)});
+        dM.mWires.push_back(WireDecl{t, n(1, 0)});
+        dM.mInstances.push_back(InstanceDecl{
+          IdString("u0"),
+          L,
+          {},
+          {ConnDecl{a, BVExpr::id(i)}, ConnDecl{y, BVExpr::id(t)}}});
+        dM.mInstances.push_back(InstanceDecl{
+          IdString("u1"),
+          L,
+          {},
+          {ConnDecl{a, BVExpr::id(t)}, ConnDecl{y, BVExpr::id(o)}}});
+
+        ModuleDecl dT;
+        dT.mName = T;
+        for (auto w : {w0, w1, w2, w3})
+            dT.mWires.push_back(WireDecl{w, n(1, 0)});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("m0"),
+          M,
+          {},
+          {ConnDecl{i, BVExpr::id(w0)}, ConnDecl{o, BVExpr::id(w1)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("m1"),
+          M,
+          {},
+          {ConnDecl{i, BVExpr::id(w1)}, ConnDecl{o, BVExpr::id(w2)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("x0"), L, {}, {ConnDecl{a, BVExpr::id(w2)}}});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("n0"),
+                       N,
+                       {},
+                       {ConnDecl{a, BVExpr::slice(w0, 0, 0)},
+                        ConnDecl{b, BVExpr::slice(w3, 0, 0)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("x1"), L, {}, {ConnDecl{y, BVExpr::id(w3)}}});
+
+        declLib.emplace(L, std::move(dL));
+        declLib.emplace(N, std::move(dN));
+        declLib.emplace(M, std::move(dM));
+        declLib.emplace(T, std::move(dT));
+
+        top = &getOrCreateSpec(declLib[T], {}, specLib);
+        linkHierarchy(*top, declLib, specLib, &std::cerr);
+        mid = &getOrCreateSpec(declLib[M], {}, specLib);
+    }
+};
+
+TEST(Hier, GlobalNetResolution) {
+    HierFixture f;
+    hier::GlobalNetResolver res(*f.top, &std::cerr);
+    IdString a("a"), y("y"), b("b");
+    auto sc = [&](std::vector<uint32_t> p) {
+        return res.scopes().intern(hier::ScopeId{std::move(p)});
+    };
+
+    // m0/u0.a[0] .. m1/u1.y[0] .. x0.a[0] are one net through feedthroughs
+    hier::GlobalNetKey k0, k1, k2, k3;
+    ASSERT_TRUE(res.resolvePort(sc({0, 0}), a, 0, k0));
+    ASSERT_TRUE(res.resolvePort(sc({1, 1}), y, 0, k1));
+    ASSERT_TRUE(res.resolvePort(sc({2}), a, 0, k2));
+    EXPECT_EQ(k0, k1);
+    EXPECT_EQ(k0, k2);
+    EXPECT_EQ(k0.mScope, hier::kRootScope);
+    // Bit 1 is a different net
+    ASSERT_TRUE(res.resolvePort(sc({0, 0}), a, 1, k3));
+    EXPECT_NE(k0, k3);
+
+    // x0.y is unconnected in Top, but x0.y == x0.a internally, so it joins
+    // the w2 net.
+    hier::GlobalNetKey ky;
+    ASSERT_TRUE(res.resolvePort(sc({2}), y, 0, ky));
+    EXPECT_EQ(ky, k0);
+
+    // N has no internal path: n0.b lands on w3, not on w0's net.
+    hier::GlobalNetKey kb, ka;
+    ASSERT_TRUE(res.resolvePort(sc({3}), b, 0, kb));
+    ASSERT_TRUE(res.resolvePort(sc({3}), a, 0, ka));
+    EXPECT_EQ(ka, k0);
+    EXPECT_NE(kb, k0);
+    EXPECT_EQ(kb.mScope, hier::kRootScope);
+
+    // x1.a is open, so its class must leave through the bound y instead.
+    hier::GlobalNetKey kx;
+    ASSERT_TRUE(res.resolvePort(sc({4}), a, 0, kx));
+    EXPECT_EQ(kx, kb);
+
+    // One summary per unique spec: Top, M, L, N
+    EXPECT_EQ(res.summaryCount(), 4u);
+}
+
+TEST(Elab, ParamOverrides) {
+    IdString P("P"), W("W"), Z("Z"), d("d");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    ModuleDecl dP;
+    dP.mName = P;
+    dP.mDefaults.emplace(W, 3);
+    dP.mPorts.push_back(PortDecl{d, PortDirection::In, n(IntExpr::id(W), 0)});
+    declLib.emplace(P, std::move(dP));
+
+    ModuleSpec& def = getOrCreateSpec(declLib[P], {}, specLib);
+    EXPECT_EQ(def.mEnv.at(W), 3);
+    EXPECT_EQ(bvExprBitWidth(BVExpr::id(d), def), 4u);
+
+    // An override replaces the default and keys a new specialization.
+    ModuleSpec& wide = getOrCreateSpec(declLib[P], {{W, 7}}, specLib);
+    EXPECT_NE(&wide, &def);
+    EXPECT_EQ(wide.mEnv.at(W), 7);
+    EXPECT_EQ(bvExprBitWidth(BVExpr::id(d), wide), 8u);
+    EXPECT_EQ(specLib.count(IdString("P#W=7")), 1u);
+
+    // Names the module does not declare are ignored.
+    ModuleSpec& same = getOrCreateSpec(declLib[P], {{Z, 5}}, specLib);
+    EXPECT_EQ(&same, &def);
+    EXPECT_FALSE(same.mEnv.count(Z));
+    EXPECT_EQ(specLib.size(), 2u);
+}
+
+TEST(Hier, ScopeTableInterning) {
+    HierFixture f;
+    hier::ScopeTable st(*f.top);
+    hier::ScopeHandle m1 = st.child(hier::kRootScope, 1);
+    hier::ScopeHandle u0 = st.intern(hier::ScopeId{{1, 0}});
+    ASSERT_NE(u0, hier::kInvalidScope);
+    EXPECT_EQ(st.child(m1, 0), u0);
+    EXPECT_EQ(st.intern(hier::ScopeId{{1, 0}}), u0);
+    EXPECT_EQ(st.size(), 3u);
+    EXPECT_EQ(st.parent(u0), m1);
+    EXPECT_EQ(st.depth(u0), 2u);
+    EXPECT_EQ(&st.spec(m1), f.mid);
+    EXPECT_EQ(st.spec(u0).mName.str(), "L");
+    EXPECT_EQ(st.instance(u0)->mName.str(), "u0");
+    EXPECT_EQ(st.toString(u0), "1/0");
+    EXPECT_EQ(st.intern(hier::ScopeId{{9}}), hier::kInvalidScope);
+
+    hier::PinKey pk;
+    ASSERT_TRUE(hier::makePinKey(st, u0, IdString("y"), pk));
+    EXPECT_EQ(pk.mScope, u0);
+    EXPECT_EQ(pk.mPortIndex, 1u);
+}
+
+TEST(Hier, Rollups) {
+    HierFixture f;
+    hier::RollupTable rt(*f.top, &std::cerr);
+    ASSERT_EQ(rt.specCount(), 4u);
+    EXPECT_EQ(rt.order().back(), f.top);
+
+    const auto& m = rt.of(*f.mid);
+    EXPECT_EQ(m.mInstances, 2u);
+    EXPECT_EQ(m.mLeafInstances, 2u);
+    EXPECT_EQ(m.mLeafPins, 8u);
+    EXPECT_EQ(m.mBits, 6u + 2 + 2 * (4u + 2));
+    EXPECT_EQ(m.mDepth, 1u);
+
+    // m0, m1 (2 each below) + x0, n0, x1
+    const auto& t = rt.of(*f.top);
+    EXPECT_EQ(t.mInstances, 9u);
+    EXPECT_EQ(t.mLeafInstances, 7u);
+    EXPECT_EQ(t.mLeafPins, 26u);
+    EXPECT_EQ(t.mBits, 8u + 2 + 2 * m.mBits + 2 * (4u + 2) + (2u + 2));
+    EXPECT_EQ(t.mDepth, 2u);
+}
+
+TEST(Hier, DumpDedupAndDepth) {
+    HierFixture f;
+    auto count = [](const std::string& s, const std::string& pat) {
+        size_t n = 0;
+        for (size_t p = s.find(pat); p != std::string::npos;
+             p = s.find(pat, p + 1))
+            ++n;
+        return n;
+    };
+    std::ostringstream full, dedup, shallow;
+    hier::dumpInstanceTree(*f.top, full);
+    EXPECT_EQ(count(full.str(), "Module 'L'"), 6u);
+
+    hier::DumpOptions d;
+    d.mDedup = true;
+    hier::dumpInstanceTree(*f.top, dedup, d);
+    // m1 is a back-reference, so its two L children are not printed.
+    EXPECT_EQ(count(dedup.str(), "Module 'L'"), 4u);
+    EXPECT_NE(dedup.str().find("scope=1 (same as scope=0)"),
+              std::string::npos);
+
+    hier::DumpOptions s;
+    s.mMaxDepth = 1;
+    hier::dumpInstanceTree(*f.top, shallow, s);
+    EXPECT_EQ(count(shallow.str(), "Module 'L'"), 2u);
+    EXPECT_EQ(count(shallow.str(), "<elided below depth 1>"), 2u);
+
+    // Both M bodies are elided, so neither may serve as a back-reference.
+    std::ostringstream both;
+    hier::DumpOptions ds;
+    ds.mDedup = true;
+    ds.mMaxDepth = 1;
+    hier::dumpInstanceTree(*f.top, both, ds);
+    EXPECT_EQ(count(both.str(), "<elided below depth 1>"), 2u);
+    EXPECT_EQ(both.str().find("same as"), std::string::npos);
+}
+
+TEST(Hier, LazyInstanceWalk) {
+    HierFixture f;
+    hier::ScopeTable st(*f.top);
+    std::vector<std::string> seen;
+    for (const auto& v : hier::walkInstances(st)) {
+        seen.push_back(st.toString(v.mScope) + ":" + v.mInst->mName.str());
+        EXPECT_EQ(st.depth(v.mScope), v.mDepth);
+        EXPECT_EQ(st.parent(v.mScope), v.mParent);
+    }
+    std::vector<std::string> want{"0:m0",
+                                  "0/0:u0",
+                                  "0/1:u1",
+                                  "1:m1",
+                                  "1/0:u0",
+                                  "1/1:u1",
+                                  "2:x0",
+                                  "3:n0",
+                                  "4:x1"};
+    EXPECT_EQ(seen, want);
+
+    hier::WalkOptions byName;
+    byName.mPruneModules.push_back(IdString("M"));
+    size_t n = 0;
+    for (const auto& v : hier::walkInstances(st, hier::kRootScope, byName)) {
+        EXPECT_EQ(v.mDepth, 1u);
+        ++n;
+    }
+    EXPECT_EQ(n, 5u);
+
+    // Start below the root; stop early without draining the generator.
+    hier::WalkOptions shallow;
+    shallow.mMaxDepth = 1;
+    auto g = hier::walkInstances(st, st.child(hier::kRootScope, 1), shallow);
+    auto it = g.begin();
+    ASSERT_FALSE(it == g.end());
+    EXPECT_EQ(st.toString(it->mScope), "1/0");
+}
+
+TEST(Hier, NamePathLookup) {
+    HierFixture f;
+    EXPECT_EQ(f.top->findInstanceIndex(IdString("n0")), 3);
+    EXPECT_EQ(f.top->findInstanceIndex(IdString("u0")), -1);
+
+    hier::PathResolver pr(*f.top);
+    hier::HierPinRef pin;
+    ASSERT_TRUE(pr.resolvePin("m1/u0.a[1]", pin));
+    EXPECT_EQ(pr.scopes().toString(pin.mPin.mScope), "1/0");
+    EXPECT_EQ(pin.mPin.mPortIndex, 0u);
+    EXPECT_EQ(pin.mBitOff, 1u);
+    EXPECT_FALSE(pin.mWholePort);
+    EXPECT_EQ(pr.pinPath(pin), "m1/u0.a[1]");
+    EXPECT_EQ(pr.cacheSize(), 2u); // "m1", "m1/u0"
+
+    // Leading top name, memoized prefix, whole port.
+    hier::HierPinRef same;
+    ASSERT_TRUE(pr.resolvePin("Top/m1/u0.a[1]", same));
+    EXPECT_EQ(same.mPin.mScope, pin.mPin.mScope);
+    ASSERT_TRUE(pr.resolvePin("m1/u1.y", same));
+    EXPECT_TRUE(same.mWholePort);
+    EXPECT_EQ(pr.pinPath(same), "m1/u1.y");
+    EXPECT_EQ(pr.resolveScope("m1/u1"), same.mPin.mScope);
+
+    EXPECT_FALSE(pr.resolvePin("m1/nope.a[0]", same));
+    EXPECT_FALSE(pr.resolvePin("m1/u0.a[2]", same));
+    EXPECT_FALSE(pr.resolvePin("m1/u0.q", same));
+}
+
+TEST(Console, UndoUnselectModuleRestoresPins) {
+    HierFixture f;
+    std::string key;
+    for (auto& kv : f.specLib)
+        if (&kv.second == f.top) key = kv.first.str();
+    std::ostringstream diag;
+    tcl::Console c(f.specLib, f.declLib, diag);
+    ASSERT_TRUE(c.init());
+    ASSERT_EQ(c.evalLine("select-spec " + key), TCL_OK);
+    ASSERT_EQ(c.evalLine("select-pin {m1/u0.a[1]}"), TCL_OK);
+    ASSERT_EQ(c.selection().mPins.size(), 1u);
+
+    ASSERT_EQ(c.evalLine("unselect-module " + key), TCL_OK);
+    EXPECT_TRUE(c.selection().mPins.empty());
+    ASSERT_EQ(c.evalLine("undo"), TCL_OK);
+    EXPECT_TRUE(c.selection().hasModuleKey(IdString::tryLookup(key)));
+    ASSERT_EQ(c.selection().mPins.size(), 1u);
+    EXPECT_EQ(c.selection().mPins[0].mPath, "m1/u0.a[1]");
+
+    // Redo replays the recorded command line; the bit select must survive.
+    ASSERT_EQ(c.evalLine("unselect-pin {m1/u0.a[1]}"), TCL_OK);
+    ASSERT_EQ(c.evalLine("undo"), TCL_OK);
+    ASSERT_EQ(c.evalLine("redo"), TCL_OK);
+    EXPECT_TRUE(c.selection().mPins.empty());
+}
+
+TEST(Console, UndoTraceConeRemovesAddedPins) {
+    // H: i -> L l0 -> t -> opaque N q0, so a cone from h0.i ends on q0.a.
+    IdString L("ConeL"), N("ConeN"), H("ConeH"), T("ConeTop");
+    IdString a("a"), y("y"), i("i"), t("t"), w("w");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dL;
+        dL.mName = L;
+        dL.mPorts.push_back(PortDecl{a, PortDirection::In, n(1, 0)});
+        dL.mPorts.push_back(PortDecl{y, PortDirection::Out, n(1, 0)});
+        dL.mAssigns.push_back(AssignDecl{BVExpr::id(y), BVExpr::id(a)});
+        ModuleDecl dN;
+        dN.mName = N;
+        dN.mPorts.push_back(PortDecl{a, PortDirection::In, n(1, 0)});
+        ModuleDecl dH;
+        dH.mName = H;
+        dH.mPorts.push_back(PortDecl{i, PortDirection::In, n(1, 0)});
+        dH.mWires.push_back(WireDecl{t, n(1, 0)});
+        dH.mInstances.push_back(
+          InstanceDecl{IdString("l0"),
+                       L,
+                       {},
+                       {ConnDecl{a, BVExpr::id(i)}, ConnDecl{y, BVExpr::id(t)}}});
+        dH.mInstances.push_back(InstanceDecl{
+          IdString("q0"), N, {}, {ConnDecl{a, BVExpr::id(t)}}});
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mWires.push_back(WireDecl{w, n(1, 0)});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("h0"), H, {}, {ConnDecl{i, BVExpr::id(w)}}});
+        declLib.emplace(L, std::move(dL));
+        declLib.emplace(N, std::move(dN));
+        declLib.emplace(H, std::move(dH));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(top, declLib, specLib, &std::cerr);
+    std::string key;
+    for (auto& kv : specLib)
+        if (&kv.second == &top) key = kv.first.str();
+
+    std::ostringstream diag;
+    tcl::Console c(specLib, declLib, diag);
+    ASSERT_TRUE(c.init());
+    ASSERT_EQ(c.evalLine("select-spec " + key), TCL_OK);
+    ASSERT_EQ(c.evalLine("select-pin {h0/q0.a[1]}"), TCL_OK);
+    ASSERT_EQ(c.evalLine("trace-cone -fanout {h0.i[0]}"), TCL_OK);
+    const auto traced = c.selection().mPins;
+    ASSERT_EQ(traced.size(), 2u);
+    EXPECT_EQ(traced[1].mPath, "h0/q0.a[0]");
+
+    ASSERT_EQ(c.evalLine("undo"), TCL_OK);
+    ASSERT_EQ(c.selection().mPins.size(), 1u);
+    EXPECT_EQ(c.selection().mPins[0].mPath, "h0/q0.a[1]");
+    ASSERT_EQ(c.evalLine("redo"), TCL_OK);
+    EXPECT_EQ(c.selection().mPins, traced);
+}
+
+TEST(Console, ListInstancesReturnsResult) {
+    HierFixture f;
+    std::string key;
+    for (auto& kv : f.specLib)
+        if (&kv.second == f.top) key = kv.first.str();
+    std::ostringstream diag;
+    tcl::Console c(f.specLib, f.declLib, diag);
+    ASSERT_TRUE(c.init());
+    ASSERT_EQ(c.evalLine("set x [list-instances " + key + " -depth 1]"),
+              TCL_OK);
+    std::string x = Tcl_GetVar(c.interp(), "x", 0);
+    EXPECT_NE(x.find("m0 : M"), std::string::npos);
+    EXPECT_NE(x.find("m1 : M"), std::string::npos);
+    EXPECT_EQ(x.find("m0/u0"), std::string::npos);
+}
+
+TEST(Hier, WhereUsedAndRootPaths) {
+    HierFixture f;
+    const ModuleSpec* L = f.top->mInstances[2].mCallee;
+    // u0, u1 in M; x0, x1 in Top
+    ASSERT_EQ(L->mUsers.size(), 4u);
+    EXPECT_EQ(f.mid->mUsers.size(), 2u);
+    std::vector<const ModuleSpec*> both{L, f.mid};
+    EXPECT_EQ(hier::whereUsed(both).size(), 6u);
+
+    // Relinking M must not duplicate its reverse edges.
+    linkInstances(*f.mid, f.declLib, f.specLib, nullptr);
+    EXPECT_EQ(L->mUsers.size(), 4u);
+
+    hier::RootPaths rp(*f.top, *L);
+    EXPECT_EQ(rp.count(), 6u);
+    std::vector<std::string> got;
+    rp.forEach([&](const hier::ScopeId& p) {
+        got.push_back(p.toString());
+        return true;
+    });
+    std::sort(got.begin(), got.end());
+    std::vector<std::string> want{"0/0", "0/1", "1/0", "1/1", "2", "4"};
+    EXPECT_EQ(got, want);
+    EXPECT_EQ(rp.forEach([](const hier::ScopeId&) { return false; }), 1u);
+
+    // Rooted at M there are two; L does not instantiate M.
+    EXPECT_EQ(hier::RootPaths(*f.mid, *L).count(), 2u);
+    EXPECT_EQ(hier::RootPaths(*L, *f.mid).count(), 0u);
+}
+
+TEST(Elab, FanoutIndex) {
+    HierFixture f;
+    const auto& fo = f.mid->mFanout;
+    ASSERT_TRUE(fo.built());
+    const auto& bm = f.mid->mBitMap;
+    // M.i[0]: driven by the input port, read by u0.a
+    net::NetId ni = bm.netOf(f.mid->portBit(IdString("i"), 0));
+    ASSERT_EQ(fo.drivers(ni).size(), 1u);
+    EXPECT_EQ(fo.drivers(ni)[0].mKind, EndpointKind::Port);
+    ASSERT_EQ(fo.loads(ni).size(), 1u);
+    EXPECT_EQ(fo.loads(ni)[0].mKind, EndpointKind::ChildPin);
+    EXPECT_EQ(fo.loads(ni)[0].mIndex, 0u);
+    // t[1]: u0.y drives, u1.a reads
+    net::NetId nt = bm.netOf(f.mid->wireBit(IdString("t"), 1));
+    ASSERT_EQ(fo.drivers(nt).size(), 1u);
+    EXPECT_EQ(fo.drivers(nt)[0].mIndex, 0u);
+    EXPECT_EQ(fo.drivers(nt)[0].mBit, 1u);
+    ASSERT_EQ(fo.loads(nt).size(), 1u);
+    EXPECT_EQ(fo.loads(nt)[0].mIndex, 1u);
+    // o[0]: u1.y drives, the output port is read from outside
+    net::NetId no = bm.netOf(f.mid->portBit(IdString("o"), 0));
+    EXPECT_EQ(fo.drivers(no).size(), 1u);
+    EXPECT_EQ(fo.loads(no).size(), 1u);
+    EXPECT_EQ(fo.loads(no)[0].mKind, EndpointKind::Port);
+
+    // Top w0[0] feeds m0.i and n0.a, with no driver.
+    net::NetId nw = f.top->mBitMap.netOf(f.top->wireBit(IdString("w0"), 0));
+    EXPECT_EQ(f.top->mFanout.drivers(nw).size(), 0u);
+    EXPECT_EQ(f.top->mFanout.loads(nw).size(), 2u);
+}
+
+TEST(Elab, InstanceTable) {
+    HierFixture f;
+    const InstanceTable& t = f.top->mInstTable;
+    ASSERT_TRUE(t.built());
+    ASSERT_EQ(t.size(), 5u);
+    EXPECT_EQ(t.mCalleeSpecs.size(), 3u); // M, L, N
+    EXPECT_EQ(t.callee(0), t.callee(1));
+    EXPECT_EQ(t.mNames[2], IdString("x0"));
+    EXPECT_EQ(t.mBits.size(), 18u);
+
+    // x0: a = w2, y open; slices are indexed by callee port bit.
+    auto x0 = t.bits(2);
+    ASSERT_EQ(x0.size(), 4u);
+    EXPECT_EQ(x0[0], f.top->wireBit(IdString("w2"), 0));
+    EXPECT_EQ(x0[1], f.top->wireBit(IdString("w2"), 1));
+    EXPECT_EQ(x0[2], InstanceTable::kOpenPin);
+    EXPECT_EQ(t.bit(2, 7), InstanceTable::kOpenPin);
+    EXPECT_EQ(hier::boundParentBit(*f.top, f.top->mInstances[3], 1),
+              f.top->wireBit(IdString("w3"), 0));
+
+    size_t builder = f.top->mInstances.capacity() * sizeof(InstanceSpec);
+    for (const auto& inst : f.top->mInstances)
+        for (const auto& c : inst.mConns)
+            builder += sizeof(ConnSpec) + c.mActual.size() * sizeof(BitAtom);
+    EXPECT_LT(t.memoryBytes(), builder);
+
+    InstanceTable packed;
+    packed.build(*f.top, 0);
+    ASSERT_TRUE(packed.packed());
+    EXPECT_TRUE(packed.mBits.empty());
+    for (uint32_t i = 0; i < t.size(); ++i)
+        for (uint32_t k = 0; k <= t.bits(i).size(); ++k)
+            EXPECT_EQ(packed.bit(i, k), t.bit(i, k));
+    std::vector<net::BitId> scratch;
+    for (uint32_t i = 0; i < t.size(); ++i) {
+        auto raw = t.bits(i).decode(scratch);
+        std::vector<net::BitId> want(raw.begin(), raw.end());
+        auto got = packed.bits(i).decode(scratch);
+        EXPECT_EQ(std::vector<net::BitId>(got.begin(), got.end()), want);
+    }
+}
+
+TEST(Hier, ConeTracing) {
+    HierFixture f;
+    hier::ScopeTable st(*f.top);
+    const auto w0 = f.top->wireBit(IdString("w0"), 0);
+    const auto w3 = f.top->wireBit(IdString("w3"), 0);
+    const auto& tbm = f.top->mBitMap;
+
+    // Fan-out of w0[0]: through both M feedthroughs and x0 (L has an
+    // assign, so it is transparent), and across the opaque n0 onto w3.
+    hier::ConeOptions fo;
+    hier::ConeResult r;
+    ASSERT_TRUE(hier::traceCone(st, hier::kRootScope, w0, fo, r));
+    EXPECT_EQ(r.mLevels, 1u);
+    ASSERT_EQ(r.mPins.size(), 1u);
+    EXPECT_EQ(st.toString(r.mPins[0].mScope), "3");
+    auto reached = [&](net::NetId n) {
+        for (const auto& cn : r.mNets)
+            if (cn.mScope == hier::kRootScope && cn.mNet == n) return true;
+        return false;
+    };
+    EXPECT_TRUE(reached(tbm.netOf(f.top->wireBit(IdString("w2"), 0))));
+    EXPECT_TRUE(reached(tbm.netOf(w3)));
+    EXPECT_FALSE(reached(tbm.netOf(f.top->wireBit(IdString("w0"), 1))));
+
+    // Same cone with a forced parallel expansion.
+    fo.mThreads = 4;
+    fo.mParallelMin = 1;
+    hier::ConeResult rp;
+    ASSERT_TRUE(hier::traceCone(st, hier::kRootScope, w0, fo, rp));
+    EXPECT_EQ(rp.mNets.size(), r.mNets.size());
+
+    // Fan-in of w3[0] stops at n0 with depth 0.
+    hier::ConeOptions fi;
+    fi.mDir = hier::ConeDir::Fanin;
+    fi.mMaxDepth = 0;
+    ASSERT_TRUE(hier::traceCone(st, hier::kRootScope, w3, fi, r));
+    EXPECT_EQ(r.mLevels, 0u);
+    ASSERT_EQ(r.mPins.size(), 1u);
+    EXPECT_EQ(r.mPins[0].mPort, 1u); // n0.b
+    fi.mMaxDepth = UINT32_MAX;
+    ASSERT_TRUE(hier::traceCone(st, hier::kRootScope, w3, fi, r));
+    EXPECT_EQ(r.mLevels, 1u);
+    EXPECT_TRUE(reached(tbm.netOf(w0)));
+}
+
+TEST(Hier, PortModels) {
+    HierFixture f;
+    hier::PortModelCache pm;
+    // M: i[k] -> o[k] through u0 and u1; port bits i = 0..1, o = 2..3.
+    const auto& m = pm.model(*f.mid);
+    EXPECT_FALSE(m.mFull);
+    EXPECT_EQ(m.arcCount(), 2u);
+    ASSERT_EQ(m.reach(0, true).size(), 1u);
+    EXPECT_EQ(m.reach(0, true)[0].mLo, 2u);
+    EXPECT_EQ(m.reach(0, true)[0].mHi, 3u);
+    ASSERT_EQ(m.reach(3, false).size(), 1u);
+    EXPECT_EQ(m.reach(3, false)[0].mLo, 1u);
+    EXPECT_TRUE(m.reach(2, true).empty());
+    const auto& nm = pm.model(*f.top->mInstances[3].mCallee);
+    EXPECT_TRUE(nm.mFull);
+    EXPECT_EQ(nm.arcCount(), 1u);
+    EXPECT_EQ(pm.size(), 3u); // L, M, N
+
+    // Abstract fan-out of w0[0] reaches the same top nets without entering
+    // m0/m1; only the opaque n0 gets a scope.
+    hier::ScopeTable st(*f.top);
+    const auto w0 = f.top->wireBit(IdString("w0"), 0);
+    hier::ConeOptions fo;
+    fo.mModels = &pm;
+    hier::ConeResult r;
+    ASSERT_TRUE(hier::traceCone(st, hier::kRootScope, w0, fo, r));
+    EXPECT_EQ(st.size(), 2u);
+    EXPECT_EQ(r.mPins.size(), 1u);
+    for (const auto& cn : r.mNets)
+        EXPECT_EQ(cn.mScope, hier::kRootScope);
+    const auto& tbm = f.top->mBitMap;
+    auto reached = [&](IdString w) {
+        auto n = tbm.netOf(f.top->wireBit(w, 0));
+        for (const auto& cn : r.mNets)
+            if (cn.mNet == n) return true;
+        return false;
+    };
+    EXPECT_TRUE(reached(IdString("w2")));
+    EXPECT_TRUE(reached(IdString("w3")));
+}
+
+TEST(Hier, CombLoops) {
+    IdString F("F"), R("R"), T("LoopTop");
+    IdString a("a"), y("y"), d("d"), q("q");
+    IdString wp("p"), wq("q"), wr("r"), ws("s");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dF; // feedthrough
+        dF.mName = F;
+        dF.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dF.mPorts.push_back(PortDecl{y, PortDirection::Out, n(0, 0)});
+        dF.mAssigns.push_back(AssignDecl{BVExpr::id(y), BVExpr::id(a)});
+        ModuleDecl dR; // opaque, e.g. a register
+        dR.mName = R;
+        dR.mPorts.push_back(PortDecl{d, PortDirection::In, n(0, 0)});
+        dR.mPorts.push_back(PortDecl{q, PortDirection::Out, n(0, 0)});
+        ModuleDecl dT;
+        dT.mName = T;
+        for (auto w : {wp, wq, wr, ws})
+            dT.mWires.push_back(WireDecl{w, n(0, 0)});
+        // p -> q by assign, q -> p through f0; r feeds back through r0 only.
+        dT.mAssigns.push_back(AssignDecl{BVExpr::id(wq), BVExpr::id(wp)});
+        dT.mAssigns.push_back(AssignDecl{BVExpr::id(ws), BVExpr::id(ws)});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("f0"),
+          F,
+          {},
+          {ConnDecl{a, BVExpr::id(wq)}, ConnDecl{y, BVExpr::id(wp)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("r0"),
+          R,
+          {},
+          {ConnDecl{d, BVExpr::id(wr)}, ConnDecl{q, BVExpr::id(wr)}}});
+        declLib.emplace(F, std::move(dF));
+        declLib.emplace(R, std::move(dR));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(top, declLib, specLib, &std::cerr);
+    hier::RollupTable rt(top);
+
+    hier::LoopOptions opts;
+    opts.mThreads = 2;
+    std::vector<hier::ModuleLoops> res;
+    ASSERT_TRUE(hier::findCombLoops(rt.order(), opts, res));
+    ASSERT_EQ(res.size(), 3u);
+    const auto& tl = res.back();
+    ASSERT_EQ(tl.mSpec, &top);
+    ASSERT_EQ(tl.mLoops.size(), 2u);
+    EXPECT_EQ(tl.mLoops[0],
+              (std::vector<net::BitId>{top.wireBit(wp, 0), top.wireBit(wq, 0)}));
+    EXPECT_EQ(tl.mLoops[1], std::vector<net::BitId>{top.wireBit(ws, 0)});
+    EXPECT_EQ(top.renderBit(tl.mLoops[1][0]), "wire s[0]");
+    EXPECT_TRUE(res[0].mLoops.empty());
+
+    std::ostringstream diag;
+    opts.mMemoryBudget = 16;
+    EXPECT_FALSE(hier::findCombLoops(rt.order(), opts, res, &diag));
+    EXPECT_TRUE(res.back().mSkipped);
+}
+
+TEST(Hier, ConstPropagation) {
+    IdString C("C"), F("F"), T("ConstTop");
+    IdString a("a"), y("y"), o("o");
+    IdString k("k"), wf("f"), wg("g"), wx("x");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dC; // o = 2'b10
+        dC.mName = C;
+        dC.mPorts.push_back(PortDecl{o, PortDirection::Out, n(1, 0)});
+        dC.mAssigns.push_back(
+          AssignDecl{BVExpr::id(o), BVExpr::number(2, 2)});
+        ModuleDecl dF; // feedthrough
+        dF.mName = F;
+        dF.mPorts.push_back(PortDecl{a, PortDirection::In, n(0, 0)});
+        dF.mPorts.push_back(PortDecl{y, PortDirection::Out, n(0, 0)});
+        dF.mAssigns.push_back(AssignDecl{BVExpr::id(y), BVExpr::id(a)});
+        ModuleDecl dT;
+        dT.mName = T;
+        dT.mWires.push_back(WireDecl{k, n(1, 0)});
+        for (auto w : {wf, wg, wx})
+            dT.mWires.push_back(WireDecl{w, n(0, 0)});
+        dT.mAssigns.push_back(
+          AssignDecl{BVExpr::id(wg), BVExpr::number(0, 1)});
+        dT.mAssigns.push_back(
+          AssignDecl{BVExpr::id(wx), BVExpr::number(0, 1)});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("c0"), C, {}, {ConnDecl{o, BVExpr::id(k)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("f0"),
+          F,
+          {},
+          {ConnDecl{a, BVExpr::slice(k, 1, 1)}, ConnDecl{y, BVExpr::id(wf)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("f1"),
+          F,
+          {},
+          {ConnDecl{a, BVExpr::slice(k, 1, 1)}, ConnDecl{y, BVExpr::id(wx)}}});
+        declLib.emplace(C, std::move(dC));
+        declLib.emplace(F, std::move(dF));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& top = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(top, declLib, specLib, &std::cerr);
+    const auto& bm = top.mBitMap;
+
+    // Constant assigns drive their own nets; nothing joins the tie nets.
+    auto tie0 = bm.netOf(bm.tieBit(false));
+    auto gNet = bm.netOf(top.wireBit(wg, 0));
+    auto xNet = bm.netOf(top.wireBit(wx, 0));
+    EXPECT_NE(gNet, tie0);
+    EXPECT_NE(gNet, xNet);
+    EXPECT_EQ(top.mConstDrivers.size(), 2u);
+    auto drv = top.mFanout.drivers(xNet);
+    ASSERT_EQ(drv.size(), 2u); // 1'b0 and f1.y
+    EXPECT_TRUE(std::any_of(drv.begin(), drv.end(), [](const auto& ep) {
+        return ep.mKind == EndpointKind::Const && ep.mIndex == 0;
+    }));
+
+    hier::ConstTable ct(top);
+    const auto& sc = ct.of(top);
+    auto val = [&](IdString w, uint32_t b) {
+        return sc.of(bm.netOf(top.wireBit(w, b)));
+    };
+    EXPECT_EQ(val(k, 0), hier::ConstVal::Zero); // from inside c0
+    EXPECT_EQ(val(k, 1), hier::ConstVal::One);
+    EXPECT_EQ(val(wf, 0), hier::ConstVal::One); // through f0
+    EXPECT_EQ(val(wg, 0), hier::ConstVal::Zero);
+    EXPECT_EQ(val(wx, 0), hier::ConstVal::Conflict); // 1'b0 and f1
+    EXPECT_EQ(sc.mConstNets, 4u);
+    EXPECT_EQ(sc.mConflictNets, 1u);
+    EXPECT_EQ(ct.of(*top.mInstances[0].mCallee).mConstNets, 2u);
+}
+
+TEST(Hier, FlatGraph) {
+    HierFixture f;
+    hier::GlobalNetResolver res(*f.top, &std::cerr);
+    hier::FlatGraphOptions opts;
+    opts.mThreads = 1;
+    hier::FlatGraph g1;
+    ASSERT_TRUE(hier::buildFlatGraph(*f.top, res, opts, g1, &std::cerr));
+
+    // m0/u0 m0/u1 m1/u0 m1/u1 x0 n0 x1; L has 4 port bits, N has 2.
+    EXPECT_EQ(g1.instanceCount(), 7u);
+    EXPECT_EQ(g1.pinCount(), 26u);
+    EXPECT_EQ(g1.mInsts[5].name().str(), "n0");
+    // w0..w2 bit 0 (+ n0.a), w0..w2 bit 1, w3 bit 0 (+ n0.b), w3 bit 1
+    ASSERT_EQ(g1.netCount(), 4u);
+    EXPECT_EQ(g1.pinsOf(0).size(), 11u);
+    EXPECT_EQ(g1.pinsOf(1).size(), 10u);
+    EXPECT_EQ(g1.pinsOf(2).size(), 3u);
+    EXPECT_EQ(g1.pinsOf(3).size(), 2u);
+    uint32_t n0a = g1.mInstPinBase[5];
+    EXPECT_EQ(g1.mPinNet[n0a], g1.mPinNet[g1.mInstPinBase[0]]);
+    EXPECT_EQ(g1.mPinNet[n0a + 1], g1.mPinNet[g1.mInstPinBase[6]]);
+
+    // Ids do not depend on the thread count.
+    opts.mThreads = 4;
+    hier::FlatGraph g4;
+    ASSERT_TRUE(hier::buildFlatGraph(*f.top, res, opts, g4, &std::cerr));
+    EXPECT_EQ(g4.mInsts, g1.mInsts);
+    EXPECT_EQ(g4.mPinNet, g1.mPinNet);
+    EXPECT_EQ(g4.mNetPins, g1.mNetPins);
+
+    std::ostringstream diag;
+    opts.mMemoryBudget = 64;
+    hier::FlatGraph gb;
+    EXPECT_FALSE(hier::buildFlatGraph(*f.top, res, opts, gb, &diag));
+    EXPECT_EQ(gb.pinCount(), 0u);
+
+    // Cells are leaves: G g0 (i=a, o=b) { BUF u (i -> o) };
+    // BUF t0 (b -> c); BUF t1 (A=c, Y open).
+    CellLibrary cells;
+    std::istringstream lib("cell BUF\n  pin A in\n  pin Y out\n"
+                           "  arc A Y\nend\n");
+    ASSERT_TRUE(cells.load(lib, nullptr));
+    IdString G("FlatGate"), T("FlatCellTop"), BUF("BUF"), A("A"), Y("Y");
+    IdString i("i"), o("o"), a("a"), b("b"), c("c");
+    ModuleDeclLib declLib;
+    ModuleSpecLib specLib;
+    {
+        ModuleDecl dG;
+        dG.mName = G;
+        dG.mPorts.push_back(PortDecl{i, PortDirection::In, n(0, 0)});
+        dG.mPorts.push_back(PortDecl{o, PortDirection::Out, n(0, 0)});
+        dG.mInstances.push_back(InstanceDecl{
+          IdString("u"), BUF, {}, {{A, BVExpr::id(i)}, {Y, BVExpr::id(o)}}});
+        ModuleDecl dT;
+        dT.mName = T;
+        for (auto w : {a, b, c})
+            dT.mWires.push_back(WireDecl{w, n(0, 0)});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("g0"), G, {}, {{i, BVExpr::id(a)}, {o, BVExpr::id(b)}}});
+        dT.mInstances.push_back(InstanceDecl{
+          IdString("t0"), BUF, {}, {{A, BVExpr::id(b)}, {Y, BVExpr::id(c)}}});
+        dT.mInstances.push_back(
+          InstanceDecl{IdString("t1"), BUF, {}, {{A, BVExpr::id(c)}}});
+        declLib.emplace(G, std::move(dG));
+        declLib.emplace(T, std::move(dT));
+    }
+    ModuleSpec& ct = getOrCreateSpec(declLib[T], {}, specLib);
+    linkHierarchy(ct, declLib, specLib, &std::cerr, &cells);
+    hier::GlobalNetResolver cres(ct, &std::cerr);
+    opts = {};
+    opts.mThreads = 1;
+    hier::FlatGraph gc;
+    ASSERT_TRUE(hier::buildFlatGraph(ct, cres, opts, gc, &std::cerr));
+    ASSERT_EQ(gc.instanceCount(), 3u);
+    ASSERT_EQ(gc.pinCount(), 6u);
+    EXPECT_TRUE(gc.mInsts[0].mPrim);
+    EXPECT_EQ(gc.mInsts[0].mParent, ct.mInstances[0].mCallee);
+    EXPECT_EQ(gc.mInsts[0].name().str(), "u");
+    EXPECT_EQ(gc.mInsts[2].name().str(), "t1");
+    // a: u.A; b: u.Y t0.A; c: t0.Y t1.A; t1.Y alone.
+    ASSERT_EQ(gc.netCount(), 4u);
+    EXPECT_EQ(gc.pinsOf(1).size(), 2u);
+    EXPECT_EQ(gc.mPinNet[1], gc.mPinNet[2]);
+    EXPECT_EQ(gc.mPinNet[3], gc.mPinNet[4]);
+    EXPECT_EQ(gc.pinsOf(gc.mPinNet[5]).size(), 1u);
+    opts.mThreads = 4;
+    hier::FlatGraph gc4;
+    ASSERT_TRUE(hier::buildFlatGraph(ct, cres, opts, gc4, &std::cerr));
+    EXPECT_EQ(gc4.mInsts, gc.mInsts);
+    EXPECT_EQ(gc4.mPinNet, gc.mPinNet);
+}
+
 TEST(ModuleKey, MakeKey) {
     IdString DO_EXTRA("DO_EXTRA");
     IdString REPL("REPL");